@@ -82,9 +82,29 @@ parser.add_option("--inj-vnet", type="int", default=-1,
                   help="Only inject in this vnet (0, 1 or 2).\
                         0 and 1 are 1-flit, 2 is 5-flit.\
                         Set to -1 to inject randomly in all vnets.")
+parser.add_option("--hotspot-nodes", type="string", default="",
+                  help="Comma separated list of hotspot destinations.")
+parser.add_option("--hotspot-fraction", type="float", default=0.0,
+                  help="Fraction of packets sent to a random node of\
+                        --hotspot-nodes instead of the --synthetic\
+                        destination.")
+parser.add_option("--burst-on-cycles", type="float", default=0.0,
+                  help="Mean length of an injection burst. Packets are\
+                        only injected during bursts (on/off MMPP), at a\
+                        rate that keeps the average at --injectionrate.\
+                        The average cannot exceed on / (on + off), as at\
+                        most one packet is injected per cycle. Set to 0\
+                        to disable.")
+parser.add_option("--burst-off-cycles", type="float", default=0.0,
+                  help="Mean number of cycles between injection bursts.")
+parser.add_option("--data-fraction", type="float", default=-1.0,
+                  help="Fraction of data (multi-flit) packets when\
+                        --inj-vnet is -1; the rest are 1-flit control\
+                        packets. Set to -1 to pick vnets uniformly.")
 parser.add_option("--sim-type", type="int", default=1,
-                  help="to run the garnet simulation in default mode\
-                  or run it in warm-up -- cool-down mode.")
+                  help="to run the garnet simulation in default mode (1),\
+                  in warm-up -- cool-down mode (2), or until the latency\
+                  and throughput confidence intervals converge (3).")
 
 #
 # Add the ruby specific and protocol specific options
@@ -106,6 +126,8 @@ if options.inj_vnet > 2:
     sys.exit(1)
 
 
+hotspot_nodes = [int(n) for n in options.hotspot_nodes.split(",") if n]
+
 cpus = [ GarnetSyntheticTraffic(
                      num_packets_max=options.num_packets_max,
                      single_sender=options.single_sender_id,
@@ -116,7 +138,14 @@ cpus = [ GarnetSyntheticTraffic(
                      inj_vnet=options.inj_vnet,
                      precision=options.precision,
                      num_dest=options.num_dirs,
-                     sim_type=options.sim_type) \
+                     sim_type=options.sim_type,
+                     mesh_rows=options.mesh_rows,
+                     hotspot_nodes=hotspot_nodes,
+                     hotspot_fraction=options.hotspot_fraction,
+                     burst_on_cycles=options.burst_on_cycles,
+                     burst_off_cycles=options.burst_off_cycles,
+                     data_fraction=options.data_fraction,
+                     max_outstanding=options.closed_loop) \
          for i in xrange(options.num_cpus) ]
 
 # create the desired simulated system
@@ -65,7 +65,8 @@ def define_options(parser):
                       help="""routing algorithm in network.
                             0: weight-based table
                             1: XY (for Mesh. see garnet2.0/RoutingUnit.cc)
-                            2: Custom (see garnet2.0/RoutingUnit.cc""")
+                            2: Custom (see garnet2.0/RoutingUnit.cc
+                            8: XY over express links (for Mesh_express)""")
     parser.add_option("--network-fault-model", action="store_true",
                       default=False,
                       help="""enable network fault model:
@@ -81,12 +82,79 @@ def define_options(parser):
                       default=0,
                       help="""policy to be used with swizzleSwap scheme;
                           default is 0; if swizzleSwap enabled then it must
-                          be non-zero""")
+                          be non-zero (1: bubble swizzle-swap, 3: spin)""")
+    parser.add_option("--spin-timeout", action="store", type="int",
+                      default=128,
+                      help="""policy 3: cycles a flit waits in switch
+                          allocation before probing for a deadlock""")
     parser.add_option("--tdm", action="store", type="int",
                       default=0,
                       help="""when to perform swizzle within a router;
                           default is 0; if swizzleSwap enabled then it must
                           be non-zero""")
+    parser.add_option("--express-interval", action="store", type="int",
+                      default=4,
+                      help="""number of routers spanned by an express link
+                          (Mesh_express topology)""")
+    parser.add_option("--express-link-latency", action="store", type="int",
+                      default=0,
+                      help="""latency of an express link; default 0 charges
+                          --link-latency per router spanned""")
+    parser.add_option("--smart-hpc-max", action="store", type="int",
+                      default=1,
+                      help="""max number of hops a flit can traverse in a
+                          single cycle (SMART bypass); default 1 disables
+                          multi-hop bypass""")
+    parser.add_option("--multicast", action="store_true", default=False,
+                      help="""inject single-flit multicasts as one packet
+                          and fork it inside the routers (garnet2.0)""")
+    parser.add_option("--escape-vc", action="store_true", default=False,
+                      help="""reserve one VC per vnet as an XY escape
+                          channel (Duato); the other VCs use
+                          --routing-algorithm, e.g. 3 (adaptive)
+                          (garnet2.0)""")
+    parser.add_option("--bubble-flow-control", action="store_true",
+                      default=False,
+                      help="""ring-based bubble flow control for tori: a
+                          packet injected into or turning onto a dimension
+                          ring needs free buffer slots for two packets
+                          downstream; use with dimension-order routing
+                          (garnet2.0)""")
+    parser.add_option("--sa-arbitration", action="store", type="int",
+                      default=0,
+                      help="""switch allocation arbitration: 0 round robin,
+                          1 oldest first, 2 most hops first, 3 starvation
+                          aware (garnet2.0)""")
+    parser.add_option("--sa-starvation-threshold", action="store",
+                      type="int", default=16,
+                      help="""--sa-arbitration=3: cycles an input VC waits
+                          before its priority escalates""")
+    parser.add_option("--telemetry-interval", action="store", type="int",
+                      default=0,
+                      help="""sample per-router occupancy, bubble position,
+                          swap counts and per-link utilization every N
+                          cycles into CSV files; default 0 disables""")
+    parser.add_option("--telemetry-file", action="store", type="string",
+                      default="garnet_telemetry",
+                      help="prefix of the telemetry CSV files")
+    parser.add_option("--latency-pair-percentiles", action="store_true",
+                      default=False,
+                      help="""dump p50/p99/p99.9 packet latency per
+                          source/destination router pair to
+                          latency_pairs.csv (garnet2.0)""")
+    parser.add_option("--ci-target", action="store", type="float",
+                      default=0.05,
+                      help="""sim-type 3: stop once the 95 percent confidence
+                          interval half-width of packet latency and
+                          accepted throughput is within this fraction of
+                          the mean""")
+    parser.add_option("--ci-batch-cycles", action="store", type="int",
+                      default=1000,
+                      help="sim-type 3: initial batch length in cycles")
+    parser.add_option("--ci-min-batches", action="store", type="int",
+                      default=10,
+                      help="sim-type 3: batches needed before stopping "
+                           "(2 to 32)")
     parser.add_option("--warmup-cycles", action="store",
                       type="int", default=1000,
                       help="number of cycles before marked packets get injected\
@@ -135,6 +203,9 @@ def init_network(options, network, InterfaceClass):
         network.sim_type = options.sim_type
         network.warmup_cycles = options.warmup_cycles
         network.marked_flits = options.marked_flits
+        network.ci_target = options.ci_target
+        network.ci_batch_cycles = options.ci_batch_cycles
+        network.ci_min_batches = options.ci_min_batches
 
     if options.network == "simple":
         network.setup_buffers()
@@ -159,9 +230,48 @@ def init_network(options, network, InterfaceClass):
         assert(options.network == "garnet2.0")
         print "setting swizzle_swap-policy to: ", options.policy
         network.policy = options.policy
+        if options.policy == 3:
+            print "setting spin_timeout to: ", options.spin_timeout
+            network.spin_timeout = options.spin_timeout
 
     if options.tdm:
         assert(options.network == "garnet2.0")
         print "setting swizzle_tdm to: ", options.tdm
         network.tdm = options.tdm
 
+    if options.smart_hpc_max > 1:
+        assert(options.network == "garnet2.0")
+        print "setting smart_hpc_max to: ", options.smart_hpc_max
+        network.smart_hpc_max = options.smart_hpc_max
+
+    if options.multicast:
+        assert(options.network == "garnet2.0")
+        print "setting multicast to: ", options.multicast
+        network.multicast = options.multicast
+
+    if options.escape_vc:
+        assert(options.network == "garnet2.0")
+        print "setting escape_vc to: ", options.escape_vc
+        network.escape_vc = options.escape_vc
+
+    if options.bubble_flow_control:
+        assert(options.network == "garnet2.0")
+        print "setting bubble_flow_control to: ", options.bubble_flow_control
+        network.bubble_flow_control = options.bubble_flow_control
+
+    if options.sa_arbitration:
+        assert(options.network == "garnet2.0")
+        print "setting sa_arbitration to: ", options.sa_arbitration
+        network.sa_arbitration = options.sa_arbitration
+        network.sa_starvation_threshold = options.sa_starvation_threshold
+
+    if options.telemetry_interval > 0:
+        assert(options.network == "garnet2.0")
+        network.telemetry_interval = options.telemetry_interval
+        network.telemetry_file = options.telemetry_file
+
+    if options.latency_pair_percentiles:
+        assert(options.network == "garnet2.0")
+        print "setting latency_pair_percentiles to: ", \
+            options.latency_pair_percentiles
+        network.latency_pair_percentiles = options.latency_pair_percentiles
@@ -40,7 +40,18 @@ from Ruby import create_topology, create_directories
 class L1Cache(RubyCache): pass
 
 def define_options(parser):
-    return
+    parser.add_option("--closed-loop", type="int", default=0,
+                      help="""max outstanding transactions per tester;
+                          each is a request in vnet 0 answered by a reply
+                          in vnet 2 (0: open loop, replies are not sent)""")
+    parser.add_option("--reply-size", type="choice", default="data",
+                      choices=["data", "control"],
+                      help="size of a closed-loop reply")
+    parser.add_option("--broadcast-requests", action="store_true",
+                      default=False,
+                      help="""send requests (vnet 0) to every directory;
+                          with --multicast they are injected as one
+                          in-network multicast""")
 
 def create_system(options, full_system, system, dma_ports, bootmem,
                   ruby_system):
@@ -80,12 +91,17 @@ def create_system(options, full_system, system, dma_ports, bootmem,
         #
         l1_cntrl = L1Cache_Controller(version = i,
                                       cacheMemory = cache,
+                                      closed_loop = options.closed_loop > 0,
+                                      broadcast_requests = \
+                                          options.broadcast_requests,
                                       ruby_system = ruby_system)
 
         cpu_seq = RubySequencer(icache = cache,
                                 dcache = cache,
                                 garnet_standalone = True,
                                 ruby_system = ruby_system)
+        if options.closed_loop > cpu_seq.max_outstanding_requests:
+            cpu_seq.max_outstanding_requests = options.closed_loop
 
         l1_cntrl.sequencer = cpu_seq
         exec("ruby_system.l1_cntrl%d = l1_cntrl" % i)
@@ -99,6 +115,7 @@ def create_system(options, full_system, system, dma_ports, bootmem,
         l1_cntrl.requestFromCache = MessageBuffer()
         l1_cntrl.responseFromCache = MessageBuffer()
         l1_cntrl.forwardFromCache = MessageBuffer()
+        l1_cntrl.replyToCache = MessageBuffer()
 
     mem_dir_cntrl_nodes, rom_dir_cntrl_node = create_directories(
         options, system.mem_ranges, bootmem, ruby_system, system)
@@ -110,6 +127,8 @@ def create_system(options, full_system, system, dma_ports, bootmem,
         dir_cntrl.requestToDir = MessageBuffer()
         dir_cntrl.forwardToDir = MessageBuffer()
         dir_cntrl.responseToDir = MessageBuffer()
+        dir_cntrl.replyFromDir = MessageBuffer()
+        dir_cntrl.reply_data = (options.reply_size == "data")
 
 
     all_cntrls = l1_cntrl_nodes + dir_cntrl_nodes
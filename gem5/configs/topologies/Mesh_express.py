@@ -0,0 +1,178 @@
+# Copyright (c) 2010 Advanced Micro Devices, Inc.
+#               2016 Georgia Institute of Technology
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: Brad Beckmann
+#          Tushar Krishna
+
+
+from m5.params import *
+from m5.objects import *
+
+from BaseTopology import SimpleTopology
+
+# Creates a generic Mesh with express links, assuming an equal number of
+# cache and directory controllers.
+# On top of the nearest-neighbor mesh links, every k-th router in a row
+# (column) is connected to the router k hops away through express links
+# with their own port directions (EastExpress, WestExpress, NorthExpress,
+# SouthExpress). k is set by --express-interval and the latency of an
+# express link by --express-link-latency.
+# Use with --routing-algorithm=8 (EXPRESS_XY_ in garnet2.0) for
+# deadlock-free dimension-ordered routing over express links.
+
+class Mesh_express(SimpleTopology):
+    description='Mesh_express'
+
+    def __init__(self, controllers):
+        self.nodes = controllers
+
+    def makeTopology(self, options, network, IntLink, ExtLink, Router):
+        nodes = self.nodes
+
+        num_routers = options.num_cpus
+        num_rows = options.mesh_rows
+        express_interval = options.express_interval
+
+        # default values for link latency and router latency.
+        # Can be over-ridden on a per link/router basis
+        link_latency = options.link_latency # used by simple and garnet
+        router_latency = options.router_latency # only used by garnet
+        # express links span several routers; by default they are
+        # charged one link latency per router spanned
+        express_latency = options.express_link_latency
+        if express_latency <= 0:
+            express_latency = link_latency * express_interval
+
+        # There must be an evenly divisible number of cntrls to routers
+        # Also, obviously the number or rows must be <= the number of routers
+        cntrls_per_router, remainder = divmod(len(nodes), num_routers)
+        assert(num_rows > 0 and num_rows <= num_routers)
+        num_columns = int(num_routers / num_rows)
+        assert(num_columns * num_rows == num_routers)
+        assert(express_interval > 1)
+
+        # Create the routers in the mesh
+        routers = [Router(router_id=i, latency = router_latency) \
+            for i in range(num_routers)]
+        network.routers = routers
+
+        # link counter to set unique link ids
+        link_count = 0
+
+        # Add all but the remainder nodes to the list of nodes to be uniformly
+        # distributed across the network.
+        network_nodes = []
+        remainder_nodes = []
+        for node_index in xrange(len(nodes)):
+            if node_index < (len(nodes) - remainder):
+                network_nodes.append(nodes[node_index])
+            else:
+                remainder_nodes.append(nodes[node_index])
+
+        # Connect each node to the appropriate router
+        ext_links = []
+        for (i, n) in enumerate(network_nodes):
+            cntrl_level, router_id = divmod(i, num_routers)
+            assert(cntrl_level < cntrls_per_router)
+            ext_links.append(ExtLink(link_id=link_count, ext_node=n,
+                                    int_node=routers[router_id],
+                                    latency = link_latency))
+            link_count += 1
+
+        # Connect the remainding nodes to router 0.  These should only be
+        # DMA nodes.
+        for (i, node) in enumerate(remainder_nodes):
+            assert(node.type == 'DMA_Controller')
+            assert(i < remainder)
+            ext_links.append(ExtLink(link_id=link_count, ext_node=node,
+                                    int_node=routers[0],
+                                    latency = link_latency))
+            link_count += 1
+
+        network.ext_links = ext_links
+
+        # Create the mesh links.
+        int_links = []
+
+        # Links along a row (span = 1 for mesh links, k for express links)
+        # East output to West input links (weight = 1)
+        # West output to East input links (weight = 1)
+        for (span, suffix, latency) in \
+            [(1, "", link_latency),
+             (express_interval, "Express", express_latency)]:
+            for row in xrange(num_rows):
+                for col in xrange(0, num_columns, span):
+                    if (col + span < num_columns):
+                        west = col + (row * num_columns)
+                        east = (col + span) + (row * num_columns)
+                        int_links.append(IntLink(link_id=link_count,
+                                                 src_node=routers[west],
+                                                 dst_node=routers[east],
+                                                 src_outport="East" + suffix,
+                                                 dst_inport="West" + suffix,
+                                                 latency = latency,
+                                                 weight=1))
+                        link_count += 1
+                        int_links.append(IntLink(link_id=link_count,
+                                                 src_node=routers[east],
+                                                 dst_node=routers[west],
+                                                 src_outport="West" + suffix,
+                                                 dst_inport="East" + suffix,
+                                                 latency = latency,
+                                                 weight=1))
+                        link_count += 1
+
+        # Links along a column
+        # North output to South input links (weight = 2)
+        # South output to North input links (weight = 2)
+        for (span, suffix, latency) in \
+            [(1, "", link_latency),
+             (express_interval, "Express", express_latency)]:
+            for col in xrange(num_columns):
+                for row in xrange(0, num_rows, span):
+                    if (row + span < num_rows):
+                        south = col + (row * num_columns)
+                        north = col + ((row + span) * num_columns)
+                        int_links.append(IntLink(link_id=link_count,
+                                                 src_node=routers[south],
+                                                 dst_node=routers[north],
+                                                 src_outport="North" + suffix,
+                                                 dst_inport="South" + suffix,
+                                                 latency = latency,
+                                                 weight=2))
+                        link_count += 1
+                        int_links.append(IntLink(link_id=link_count,
+                                                 src_node=routers[north],
+                                                 dst_node=routers[south],
+                                                 src_outport="South" + suffix,
+                                                 dst_inport="North" + suffix,
+                                                 latency = latency,
+                                                 weight=2))
+                        link_count += 1
+
+
+        network.int_links = int_links
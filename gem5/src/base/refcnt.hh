@@ -163,6 +163,16 @@ class RefCountingPtr
     /// one.  Adds a reference.
     RefCountingPtr(const RefCountingPtr &r) { copy(r.data); }
 
+    /// Create a new reference counting pointer by taking over the
+    /// reference of another one, which is left empty.  The reference
+    /// count is not touched.
+    RefCountingPtr(RefCountingPtr &&r) noexcept : data(r.data) { r.data = 0; }
+
+    /// Create a new reference counting pointer from one to a derived
+    /// type.  Adds a reference.
+    template <class U>
+    RefCountingPtr(const RefCountingPtr<U> &r) { copy(r.get()); }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
@@ -186,6 +196,19 @@ class RefCountingPtr
     const RefCountingPtr &operator=(const RefCountingPtr &r)
     { return operator=(r.data); }
 
+    /// Move the pointer from another RefCountingPtr, leaving it empty.
+    /// Only the reference this pointer held before is dropped.
+    const RefCountingPtr &
+    operator=(RefCountingPtr &&r) noexcept
+    {
+        if (this != &r) {
+            del();
+            data = r.data;
+            r.data = 0;
+        }
+        return *this;
+    }
+
     /// Check if the pointer is empty
     bool operator!() const { return data == 0; }
 
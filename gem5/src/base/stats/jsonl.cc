@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/jsonl.hh"
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "base/stats/info.hh"
+#include "sim/core.hh"
+
+using namespace std;
+
+namespace Stats {
+
+namespace {
+
+void
+writeString(ostream &os, const string &str)
+{
+    os << '"';
+    for (char c : str) {
+        switch (c) {
+          case '"': os << "\\\""; break;
+          case '\\': os << "\\\\"; break;
+          case '\n': os << "\\n"; break;
+          case '\t': os << "\\t"; break;
+          default:
+            if ((unsigned char)c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                os << buf;
+            } else {
+                os << c;
+            }
+        }
+    }
+    os << '"';
+}
+
+void
+writeNumber(ostream &os, Result value)
+{
+    if (!std::isfinite(value)) {
+        os << "null";
+    } else if (value == rint(value) && fabs(value) < 9007199254740992.0) {
+        // Counters are almost always integral; keep them short.
+        os << (long long)value;
+    } else {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.17g", value);
+        os << buf;
+    }
+}
+
+template <class T>
+void
+writeNumbers(ostream &os, const vector<T> &values)
+{
+    os << '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i)
+            os << ',';
+        writeNumber(os, values[i]);
+    }
+    os << ']';
+}
+
+/** Write a "key":[...] schema member if any of the names are set. */
+void
+writeNames(ostream &os, const char *key, const vector<string> &names)
+{
+    bool any = false;
+    for (const auto &name : names)
+        any = any || !name.empty();
+    if (!any)
+        return;
+
+    os << ",\"" << key << "\":[";
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i)
+            os << ',';
+        writeString(os, names[i]);
+    }
+    os << ']';
+}
+
+const char *
+distTypeName(DistType type)
+{
+    switch (type) {
+      case Deviation: return "deviation";
+      case Dist: return "dist";
+      case Hist: return "hist";
+    }
+    return "unknown";
+}
+
+void
+writeDist(ostream &os, const DistData &data)
+{
+    os << "{\"min\":";
+    writeNumber(os, data.min);
+    os << ",\"max\":";
+    writeNumber(os, data.max);
+    os << ",\"bucket_size\":";
+    writeNumber(os, data.bucket_size);
+    os << ",\"samples\":";
+    writeNumber(os, data.samples);
+    os << ",\"sum\":";
+    writeNumber(os, data.sum);
+    os << ",\"squares\":";
+    writeNumber(os, data.squares);
+    if (data.type == Hist) {
+        os << ",\"logs\":";
+        writeNumber(os, data.logs);
+    }
+    if (data.type == Dist) {
+        os << ",\"min_val\":";
+        writeNumber(os, data.min_val);
+        os << ",\"max_val\":";
+        writeNumber(os, data.max_val);
+        os << ",\"underflow\":";
+        writeNumber(os, data.underflow);
+        os << ",\"overflow\":";
+        writeNumber(os, data.overflow);
+    }
+    if (data.type != Deviation) {
+        os << ",\"buckets\":";
+        writeNumbers(os, data.cvec);
+    }
+    os << '}';
+}
+
+} // anonymous namespace
+
+JsonLines::JsonLines()
+    : stream(NULL), schemaWritten(false), numValues(0), numDumps(0)
+{
+}
+
+JsonLines::JsonLines(std::ostream &stream)
+    : JsonLines()
+{
+    open(stream);
+}
+
+void
+JsonLines::open(std::ostream &_stream)
+{
+    if (stream)
+        panic("stream already set!");
+
+    stream = &_stream;
+    if (!valid())
+        fatal("Unable to open output stream for writing\n");
+}
+
+bool
+JsonLines::valid() const
+{
+    return stream != NULL && stream->good();
+}
+
+void
+JsonLines::begin()
+{
+    values.str("");
+    numValues = 0;
+}
+
+void
+JsonLines::end()
+{
+    if (!schemaWritten) {
+        *stream << "{\"type\":\"schema\",\"version\":1,\"separator\":";
+        writeString(*stream, Info::separatorString);
+        *stream << ",\"stats\":[" << schema.str() << "]}\n";
+        schema.str("");
+        schemaWritten = true;
+    }
+
+    *stream << "{\"type\":\"dump\",\"seq\":" << numDumps++
+            << ",\"tick\":" << curTick()
+            << ",\"stats\":{" << values.str() << "}}\n";
+    stream->flush();
+}
+
+bool
+JsonLines::noOutput(const Info &info)
+{
+    return !info.flags.isSet(display);
+}
+
+void
+JsonLines::record(const Info &info, const char *kind, const string &extra,
+                  const string &value)
+{
+    if (!schemaWritten) {
+        if (schema.tellp() > 0)
+            schema << ',';
+        schema << "{\"id\":" << info.id << ",\"name\":";
+        writeString(schema, info.name);
+        schema << ",\"kind\":\"" << kind << "\",\"desc\":";
+        writeString(schema, info.desc);
+        schema << extra << '}';
+    }
+
+    auto last = lastValues.find(info.id);
+    if (last != lastValues.end() && last->second == value)
+        return;
+
+    if (numValues++)
+        values << ',';
+    values << '"' << info.id << "\":" << value;
+
+    if (last != lastValues.end())
+        last->second = value;
+    else
+        lastValues.emplace(info.id, value);
+}
+
+void
+JsonLines::visit(const ScalarInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    ostringstream value;
+    writeNumber(value, info.result());
+    record(info, "scalar", "", value.str());
+}
+
+void
+JsonLines::visit(const VectorInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    ostringstream extra, value;
+    writeNames(extra, "subnames", info.subnames);
+    writeNumbers(value, info.result());
+    record(info, "vector", extra.str(), value.str());
+}
+
+void
+JsonLines::visit(const Vector2dInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    ostringstream extra, value;
+    extra << ",\"x\":" << info.x << ",\"y\":" << info.y;
+    writeNames(extra, "subnames", info.subnames);
+    writeNames(extra, "y_subnames", info.y_subnames);
+    writeNumbers(value, info.cvec);
+    record(info, "vector2d", extra.str(), value.str());
+}
+
+void
+JsonLines::visit(const DistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    ostringstream extra, value;
+    extra << ",\"dist_type\":\"" << distTypeName(info.data.type) << '"';
+    writeDist(value, info.data);
+    record(info, "dist", extra.str(), value.str());
+}
+
+void
+JsonLines::visit(const VectorDistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    ostringstream extra, value;
+    if (!info.data.empty()) {
+        extra << ",\"dist_type\":\""
+              << distTypeName(info.data[0].type) << '"';
+    }
+    writeNames(extra, "subnames", info.subnames);
+
+    value << '[';
+    for (size_t i = 0; i < info.data.size(); ++i) {
+        if (i)
+            value << ',';
+        writeDist(value, info.data[i]);
+    }
+    value << ']';
+    record(info, "vectordist", extra.str(), value.str());
+}
+
+void
+JsonLines::visit(const FormulaInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    // A formula's total is the formula applied to the operand totals,
+    // not the sum of its elements, so it is kept alongside them.
+    ostringstream extra, value;
+    writeNames(extra, "subnames", info.subnames);
+    value << "{\"values\":";
+    writeNumbers(value, info.result());
+    value << ",\"total\":";
+    writeNumber(value, info.total());
+    value << '}';
+    record(info, "formula", extra.str(), value.str());
+}
+
+void
+JsonLines::visit(const SparseHistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    ostringstream value;
+    value << "{\"samples\":";
+    writeNumber(value, info.data.samples);
+    value << ",\"buckets\":[";
+    for (auto i = info.data.cmap.begin(); i != info.data.cmap.end(); ++i) {
+        if (i != info.data.cmap.begin())
+            value << ',';
+        value << '[';
+        writeNumber(value, i->first);
+        value << ',' << i->second << ']';
+    }
+    value << "]}";
+    record(info, "sparsehist", "", value.str());
+}
+
+Output *
+initJsonLines(const string &filename)
+{
+    static JsonLines jsonl;
+    static bool connected = false;
+
+    if (!connected) {
+        jsonl.open(*simout.findOrCreate(filename)->stream());
+        connected = true;
+    }
+
+    return &jsonl;
+}
+
+} // namespace Stats
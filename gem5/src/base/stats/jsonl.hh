@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_JSONL_HH__
+#define __BASE_STATS_JSONL_HH__
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "base/stats/output.hh"
+#include "base/stats/types.hh"
+
+namespace Stats {
+
+/**
+ * Machine-readable stats output as JSON lines. The first dump writes one
+ * "schema" record describing every displayed stat (id, name, kind,
+ * description, subnames and shape); every dump then writes one "dump"
+ * record with the tick and the values of only those stats that changed
+ * since the previous dump, keyed by id. A reader rebuilds the full state
+ * of dump n by applying records 0..n in order.
+ *
+ * Unlike Text, the nozero/nonan flags and prereqs are ignored, since a
+ * stat that disappears from the output would read as unchanged. NaN and
+ * infinities are written as null. util/jsonl_stats.py loads the files.
+ */
+class JsonLines : public Output
+{
+  protected:
+    std::ostream *stream;
+
+    /** Schema entries, collected during the first dump. */
+    std::ostringstream schema;
+    bool schemaWritten;
+
+    /** Changed values of the dump in progress. */
+    std::ostringstream values;
+    unsigned numValues;
+
+    /** Last written value of each stat id, for delta encoding. */
+    std::map<int, std::string> lastValues;
+    uint64_t numDumps;
+
+    bool noOutput(const Info &info);
+
+    /**
+     * Add a stat to the current dump. extra holds the kind-specific
+     * schema members (each prefixed with a comma) and value its
+     * serialized value.
+     */
+    void record(const Info &info, const char *kind, const std::string &extra,
+                const std::string &value);
+
+  public:
+    JsonLines();
+    JsonLines(std::ostream &stream);
+
+    void open(std::ostream &stream);
+
+    // Implement Visit
+    virtual void visit(const ScalarInfo &info);
+    virtual void visit(const VectorInfo &info);
+    virtual void visit(const DistInfo &info);
+    virtual void visit(const VectorDistInfo &info);
+    virtual void visit(const Vector2dInfo &info);
+    virtual void visit(const FormulaInfo &info);
+    virtual void visit(const SparseHistInfo &info);
+
+    // Implement Output
+    virtual bool valid() const;
+    virtual void begin();
+    virtual void end();
+};
+
+Output *initJsonLines(const std::string &filename);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_JSONL_HH__
@@ -30,6 +30,7 @@
 
 #include "cpu/testers/garnet_synthetic_traffic/GarnetSyntheticTraffic.hh"
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <set>
@@ -72,12 +73,19 @@ GarnetSyntheticTraffic::sendPkt(PacketPtr pkt)
         retryPkt = pkt; // RubyPort will retry sending
     }
     numPacketsSent++;
+
+    if (numPacketsOutstanding++ == 0)
+        lastProgressCycle = curCycle();
+    if (!deadlockCheckEvent.scheduled())
+        schedule(deadlockCheckEvent, clockEdge(responseLimit));
 }
 
 GarnetSyntheticTraffic::GarnetSyntheticTraffic(const Params *p)
     : MemObject(p),
       tickEvent([this]{ tick(); }, "GarnetSyntheticTraffic tick",
                 false, Event::CPU_Tick_Pri),
+      deadlockCheckEvent([this]{ checkDeadlock(); },
+                         "GarnetSyntheticTraffic deadlock check"),
       cachePort("GarnetSyntheticTraffic", this),
       retryPkt(NULL),
       size(p->memory_size),
@@ -93,11 +101,30 @@ GarnetSyntheticTraffic::GarnetSyntheticTraffic(const Params *p)
       injRate(p->inj_rate),
       injVnet(p->inj_vnet),
       precision(p->precision),
+      hotspotNodes(p->hotspot_nodes),
+      hotspotFraction(p->hotspot_fraction),
+      burstOnCycles(p->burst_on_cycles),
+      burstOffCycles(p->burst_off_cycles),
+      burstOn(true),
+      burstEndCycle(0),
+      dataFraction(p->data_fraction),
+      maxOutstanding(p->max_outstanding),
+      injectionBlocked(false),
+      tagShift(0),
+      statsStartCycle(0),
       responseLimit(p->response_limit),
       masterId(p->system->getMasterId(name()))
 {
     // set up counters
-    noResponseCycles = 0;
+    numPacketsOutstanding = 0;
+    lastProgressCycle = Cycles(0);
+
+    // The injection process is a Bernoulli trial per cycle with the
+    // injection rate rounded up to 'precision' digits. Instead of a
+    // trial every cycle, the tester draws the geometric gap to the next
+    // success and only wakes up then.
+    double injRange = pow((double) 10, (double) precision);
+    injProb = std::min(1.0, ceil(injRate * injRange) / injRange);
     schedule(tickEvent, 0);
 
     initTrafficType();
@@ -107,6 +134,45 @@ GarnetSyntheticTraffic::GarnetSyntheticTraffic(const Params *p)
     traffic = trafficStringToEnum[trafficType];
 
     id = TESTER_NETWORK++;
+    nextInjectTick = MaxTick;
+
+    meshRows = p->mesh_rows;
+    if (meshRows <= 0)
+        meshRows = (int) sqrt(numDestinations);
+    meshCols = numDestinations / meshRows;
+    fatal_if(meshRows * meshCols != numDestinations,
+             "%d destinations do not form a mesh with %d rows\n",
+             numDestinations, meshRows);
+
+    permDest = permutationDest(id);
+
+    for (int i = 0; i < (int) hotspotNodes.size(); i++) {
+        fatal_if(hotspotNodes[i] < 0 || hotspotNodes[i] >= numDestinations,
+                 "hotspot node %d out of range\n", hotspotNodes[i]);
+    }
+    fatal_if(hotspotFraction > 0 && hotspotNodes.empty(),
+             "hotspot_fraction needs at least one hotspot node\n");
+    fatal_if(burstOnCycles > 0 && burstOffCycles <= 0,
+             "bursty injection needs burst_off_cycles > 0\n");
+    // Within a burst at most one packet is injected per cycle, so the
+    // in-burst probability is capped at 1 and the mean rate falls short.
+    if (burstOnCycles > 0 &&
+        injProb * (burstOnCycles + burstOffCycles) / burstOnCycles > 1.0) {
+        warn_once("injection rate %f cannot be reached with bursts of %f "
+                  "on / %f off cycles; the mean rate is capped at %f\n",
+                  injProb, burstOnCycles, burstOffCycles,
+                  burstOnCycles / (burstOnCycles + burstOffCycles));
+    }
+
+    if (maxOutstanding > 0) {
+        int dest_bits = 0;
+        while ((1 << dest_bits) < numDestinations)
+            dest_bits++;
+        tagShift = blockSizeBits + dest_bits;
+        tagIssueCycle.resize(maxOutstanding);
+        for (int tag = maxOutstanding - 1; tag >= 0; tag--)
+            freeTags.push_back(tag);
+    }
     DPRINTF(GarnetSyntheticTraffic,"Config Created: Name = %s , and id = %d\n",
             name(), id);
 }
@@ -124,6 +190,19 @@ void
 GarnetSyntheticTraffic::init()
 {
     numPacketsSent = 0;
+
+    if (injProb > 0 && (singleSender < 0 || singleSender == id)) {
+        if (burstOnCycles > 0) {
+            // start in the stationary state of the on/off chain
+            double u = random_mt.random<double>();
+            burstOn = u < burstOnCycles / (burstOnCycles + burstOffCycles);
+            double mean = burstOn ? burstOnCycles : burstOffCycles;
+            burstEndCycle = curCycle() +
+                Cycles(geometricTrials(std::min(1.0, 1.0 / mean)));
+        }
+        // the first trial is at cycle 0
+        scheduleNextInjection(curCycle());
+    }
 }
 
 
@@ -138,7 +217,29 @@ GarnetSyntheticTraffic::completeRequest(PacketPtr pkt)
             req->getPaddr());
 
     assert(pkt->isResponse());
-    noResponseCycles = 0;
+    numPacketsOutstanding--;
+    lastProgressCycle = curCycle();
+
+    if (maxOutstanding > 0) {
+        int tag = req->getPaddr() >> tagShift;
+        assert(tag < maxOutstanding);
+        Cycles round_trip = curCycle() - tagIssueCycle[tag];
+        numTransactions++;
+        totalRoundTrip += round_trip;
+        roundTripHist.sample(round_trip);
+        freeTags.push_back(tag);
+
+        // a request was held back by the limit: issue it next cycle
+        if (injectionBlocked) {
+            injectionBlocked = false;
+            nextInjectTick = clockEdge(Cycles(1));
+            if (!tickEvent.scheduled())
+                schedule(tickEvent, nextInjectTick);
+            else if (tickEvent.when() > nextInjectTick)
+                reschedule(tickEvent, nextInjectTick);
+        }
+    }
+
     delete req;
     delete pkt;
 }
@@ -147,58 +248,123 @@ GarnetSyntheticTraffic::completeRequest(PacketPtr pkt)
 void
 GarnetSyntheticTraffic::tick()
 {
-    if (++noResponseCycles >= responseLimit) {
-        fatal("%s deadlocked at cycle %d\n", name(), curTick());
+    if (curTick() >= nextInjectTick) {
+        if (maxOutstanding > 0 &&
+            numPacketsOutstanding >= maxOutstanding) {
+            // like a core with all MSHRs busy: the request waits for a
+            // reply, and no further requests are generated meanwhile
+            injectionBlocked = true;
+            nextInjectTick = MaxTick;
+        } else {
+            // always generatePkt unless fixedPkts is enabled
+            if (numPacketsMax < 0 || numPacketsSent < numPacketsMax)
+                generatePkt();
+
+            scheduleNextInjection(curCycle() + Cycles(1));
+        }
     }
 
-    // make new request based on injection rate
-    // (injection rate's range depends on precision)
-    // - generate a random number between 0 and 10^precision
-    // - send pkt if this number is < injRate*(10^precision)
-    bool sendAllowedThisCycle;
-    double injRange = pow((double) 10, (double) precision);
-    unsigned trySending = random_mt.random<unsigned>(0, (int) injRange);
-    if (trySending < injRate*injRange)
-        sendAllowedThisCycle = true;
-    else
-        sendAllowedThisCycle = false;
-
-    // always generatePkt unless fixedPkts or singleSender is enabled
-    if (sendAllowedThisCycle) {
-        bool senderEnable = true;
+    // Schedule wakeup
+    if (sim_type == 1) {
+        if (curTick() >= simCycles) {
+            exitSimLoop("Network Tester completed simCycles");
+            return;
+        }
+    } else if (sim_type == 3) {
+        // the network exits once its confidence intervals converge;
+        // simCycles only caps runs that never do
+        if (curTick() >= simCycles) {
+            exitSimLoop("Network Tester completed simCycles before the "
+                        "confidence intervals converged");
+            return;
+        }
+    } else if (sim_type != 2) {
+        fatal("unknown 'sim_type: %d' option given", sim_type);
+    }
 
-        if (numPacketsMax >= 0 && numPacketsSent >= numPacketsMax)
-            senderEnable = false;
+    // Wake up at the next injection, or at the end of the run if that
+    // comes first (sim_type 2 runs until the network exits).
+    Tick when = nextInjectTick;
+    if (sim_type != 2 && simCycles < when)
+        when = clockEdge(ticksToCycles(simCycles - curTick()));
+    if (when != MaxTick && !tickEvent.scheduled())
+        schedule(tickEvent, when);
+}
 
-        if (singleSender >= 0 && id != singleSender)
-            senderEnable = false;
+// Number of Bernoulli(p) trials up to and including the first success.
+uint64_t
+GarnetSyntheticTraffic::geometricTrials(double p)
+{
+    if (p >= 1.0)
+        return 1;
+    double u = random_mt.random<double>(); // [0, 1)
+    double trials = floor(log(1.0 - u) / log(1.0 - p));
+    // cap far beyond any sensible run length to stay in range
+    return 1 + (uint64_t) std::min(trials, 1e15);
+}
 
-        if (senderEnable)
-            generatePkt();
+// Find the next successful trial at or after first_trial. With bursty
+// injection, trials only happen in the on state, at the rate that
+// keeps the long-run average equal to injRate.
+void
+GarnetSyntheticTraffic::scheduleNextInjection(Cycles first_trial)
+{
+    if (numPacketsMax >= 0 && numPacketsSent >= numPacketsMax) {
+        nextInjectTick = MaxTick;
+        return;
     }
 
-    // Schedule wakeup
-    if (sim_type == 1) {
-        if (curTick() >= simCycles)
-            exitSimLoop("Network Tester completed simCycles");
-        else {
-            if (!tickEvent.scheduled())
-                schedule(tickEvent, clockEdge(Cycles(1)));
-        }
-    } else if(sim_type == 2) {
-        if (!tickEvent.scheduled())
-        schedule(tickEvent, clockEdge(Cycles(1)));
-//        fatal("sim_type: %d is not implemented currently!", sim_type);
+    uint64_t next;
+    if (burstOnCycles <= 0) {
+        next = first_trial + geometricTrials(injProb) - 1;
     } else {
-        fatal("unknown 'sim_type: %d' option given", sim_type);
+        double on_prob = std::min(1.0, injProb *
+            (burstOnCycles + burstOffCycles) / burstOnCycles);
+        double on_end = std::min(1.0, 1.0 / burstOnCycles);
+        double off_end = std::min(1.0, 1.0 / burstOffCycles);
+
+        uint64_t trial = first_trial;
+        while (true) {
+            if (!burstOn) {
+                trial = std::max(trial, (uint64_t) burstEndCycle);
+                burstOn = true;
+                burstEndCycle = Cycles(trial + geometricTrials(on_end));
+            }
+            next = trial + geometricTrials(on_prob) - 1;
+            if (next < burstEndCycle)
+                break;
+            // no injection left in this burst: skip the off period
+            trial = burstEndCycle;
+            burstOn = false;
+            burstEndCycle = Cycles(trial + geometricTrials(off_end));
+        }
     }
+
+    assert(next >= curCycle());
+    nextInjectTick = clockEdge(Cycles(next - curCycle()));
+}
+
+// Only checked while requests are outstanding, once per responseLimit
+// cycles, instead of counting idle cycles on every tick.
+void
+GarnetSyntheticTraffic::checkDeadlock()
+{
+    if (numPacketsOutstanding == 0)
+        return;
+
+    Cycles waited = curCycle() - lastProgressCycle;
+    if (waited >= responseLimit) {
+        fatal("%s deadlocked at cycle %d\n", name(), curTick());
+    }
+
+    schedule(deadlockCheckEvent, clockEdge(Cycles(responseLimit - waited)));
 }
 
 void
 GarnetSyntheticTraffic::generatePkt()
 {
     int num_destinations = numDestinations;
-    int radix = (int) sqrt(num_destinations);
+    int radix = meshCols;
     unsigned destination = id;
     int dest_x = -1;
     int dest_y = -1;
@@ -209,47 +375,16 @@ GarnetSyntheticTraffic::generatePkt()
     if (singleDest >= 0)
     {
         destination = singleDest;
+    } else if (hotspotFraction > 0 &&
+               random_mt.random<double>() < hotspotFraction) {
+        int pick = random_mt.random<int>(0, hotspotNodes.size() - 1);
+        destination = hotspotNodes[pick];
     } else if (traffic == UNIFORM_RANDOM_) {
         destination = random_mt.random<unsigned>(0, num_destinations - 1);
-    } else if (traffic == BIT_COMPLEMENT_) {
-        dest_x = radix - src_x - 1;
-        dest_y = radix - src_y - 1;
-        destination = dest_y*radix + dest_x;
-    } else if (traffic == BIT_REVERSE_) {
-        unsigned int straight = source;
-        unsigned int reverse = source & 1; // LSB
-
-        int num_bits = (int) log2(num_destinations);
-
-        for (int i = 1; i < num_bits; i++)
-        {
-            reverse <<= 1;
-            straight >>= 1;
-            reverse |= (straight & 1); // LSB
-        }
-        destination = reverse;
-    } else if (traffic == BIT_ROTATION_) {
-        if (source%2 == 0)
-            destination = source/2;
-        else // (source%2 == 1)
-            destination = ((source/2) + (num_destinations/2));
-    } else if (traffic == NEIGHBOR_) {
-            dest_x = (src_x + 1) % radix;
-            dest_y = src_y;
-            destination = dest_y*radix + dest_x;
-    } else if (traffic == SHUFFLE_) {
-        if (source < num_destinations/2)
-            destination = source*2;
-        else
-            destination = (source*2 - num_destinations + 1);
-    } else if (traffic == TRANSPOSE_) {
-            dest_x = src_y;
-            dest_y = src_x;
-            destination = dest_y*radix + dest_x;
-    } else if (traffic == TORNADO_) {
-        dest_x = (src_x + (int) ceil(radix/2) - 1) % radix;
-        dest_y = src_y;
-        destination = dest_y*radix + dest_x;
+    } else if (permDest >= 0) {
+        // bit_complement, bit_reverse, bit_rotation, neighbor, shuffle,
+        // transpose and tornado
+        destination = permDest;
     } // real traffic patterns starts from here...
     else if (traffic == HADOOP_) {
         int root = 0;
@@ -302,7 +437,7 @@ GarnetSyntheticTraffic::generatePkt()
         {
             dest_x = src_x;
             dest_y = src_y + 1;
-            if (dest_y == radix)
+            if (dest_y == meshRows)
                 dest_y = 0;
         }
         else if (rand == 2) // west
@@ -317,7 +452,7 @@ GarnetSyntheticTraffic::generatePkt()
             dest_x = src_x;
             dest_y = src_y -1;
             if (dest_y == -1)
-                dest_y = radix - 1;
+                dest_y = meshRows - 1;
         }
 
         destination = dest_y*radix + dest_x;
@@ -376,7 +511,23 @@ GarnetSyntheticTraffic::generatePkt()
     // Vnet 2 is for data packets (5-flit)
     int injReqType = injVnet;
 
-    if (injReqType < 0 || injReqType > 2)
+    if (maxOutstanding > 0) {
+        // closed-loop requests are loads (vnet 0); the reply comes back
+        // in vnet 2
+        injReqType = 0;
+        int tag = freeTags.back();
+        freeTags.pop_back();
+        tagIssueCycle[tag] = curCycle();
+        paddr |= (Addr) tag << tagShift;
+    } else if ((injReqType < 0 || injReqType > 2) && dataFraction >= 0)
+    {
+        // data packets with the given probability, otherwise a
+        // control packet in vnet 0 or 1
+        if (random_mt.random<double>() < dataFraction)
+            injReqType = 2;
+        else
+            injReqType = random_mt.random(0, 1);
+    } else if (injReqType < 0 || injReqType > 2)
     {
         // randomly inject in any vnet
         injReqType = random_mt.random(0, 2);
@@ -414,6 +565,109 @@ GarnetSyntheticTraffic::generatePkt()
     sendPkt(pkt);
 }
 
+// Destination of 'source' under a permutation pattern, or -1 for the
+// other patterns. Coordinate patterns use the meshRows x meshCols shape.
+// Bit patterns are bijections on [0, 2^b) with 2^b >= numDestinations;
+// for other node counts they are applied again until the result is a
+// valid node (cycle walking), which keeps them permutations.
+int
+GarnetSyntheticTraffic::permutationDest(int source)
+{
+    int num_destinations = numDestinations;
+    int src_x = source % meshCols;
+    int src_y = source / meshCols;
+    int num_bits = 0;
+    while ((1 << num_bits) < num_destinations)
+        num_bits++;
+    unsigned mask = (1 << num_bits) - 1;
+
+    if (traffic == BIT_COMPLEMENT_) {
+        return (meshRows - src_y - 1) * meshCols + (meshCols - src_x - 1);
+    } else if (traffic == NEIGHBOR_) {
+        return src_y * meshCols + (src_x + 1) % meshCols;
+    } else if (traffic == TRANSPOSE_) {
+        // row-major to column-major order; (x, y) -> (y, x) if square
+        return src_x * meshRows + src_y;
+    } else if (traffic == TORNADO_) {
+        int shift = (meshCols + 1) / 2 - 1;
+        return src_y * meshCols + (src_x + shift) % meshCols;
+    } else if (traffic != BIT_REVERSE_ && traffic != BIT_ROTATION_ &&
+               traffic != SHUFFLE_) {
+        return -1;
+    }
+
+    if (num_bits == 0)
+        return source;
+
+    unsigned dest = source;
+    do {
+        unsigned straight = dest;
+        if (traffic == BIT_REVERSE_) {
+            dest = 0;
+            for (int i = 0; i < num_bits; i++) {
+                dest = (dest << 1) | (straight & 1);
+                straight >>= 1;
+            }
+        } else if (traffic == BIT_ROTATION_) {
+            // rotate right by one
+            dest = (straight >> 1) | ((straight & 1) << (num_bits - 1));
+        } else {
+            // SHUFFLE_: rotate left by one
+            dest = ((straight << 1) | (straight >> (num_bits - 1))) & mask;
+        }
+    } while (dest >= (unsigned) num_destinations);
+
+    return dest;
+}
+
+void
+GarnetSyntheticTraffic::regStats()
+{
+    MemObject::regStats();
+
+    // The closed-loop stats stay zero in open-loop runs; keep them (and
+    // the NaN average) out of stats.txt there.
+    numTransactions
+        .name(name() + ".transactions")
+        .desc("closed loop: requests that got their reply")
+        .flags(Stats::nozero);
+    totalRoundTrip
+        .name(name() + ".total_round_trip")
+        .desc("closed loop: sum of round-trip latencies (cycles)")
+        .flags(Stats::nozero);
+    roundTripHist
+        .init(100)
+        .name(name() + ".round_trip_histogram")
+        .desc("closed loop: round-trip latency (cycles)")
+        .flags(Stats::pdf | Stats::total | Stats::nozero | Stats::oneline);
+    avgRoundTrip
+        .name(name() + ".avg_round_trip")
+        .desc("closed loop: average round-trip latency (cycles)")
+        .flags(Stats::nozero | Stats::nonan);
+    avgRoundTrip = totalRoundTrip / numTransactions;
+    transactionRate
+        .method(this, &GarnetSyntheticTraffic::getTransactionRate)
+        .name(name() + ".transaction_rate")
+        .desc("closed loop: transactions per cycle since the last reset")
+        .flags(Stats::nozero);
+}
+
+void
+GarnetSyntheticTraffic::resetStats()
+{
+    MemObject::resetStats();
+    statsStartCycle = curCycle();
+}
+
+double
+GarnetSyntheticTraffic::getTransactionRate() const
+{
+    Cycles elapsed = curCycle() - statsStartCycle;
+    if (elapsed == 0)
+        return 0;
+    return numTransactions.value() / (double) elapsed;
+}
+
 void
 GarnetSyntheticTraffic::initTrafficType()
 {
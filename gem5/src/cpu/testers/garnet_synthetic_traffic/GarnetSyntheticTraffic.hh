@@ -32,6 +32,7 @@
 #define __CPU_GARNET_SYNTHETIC_TRAFFIC_HH__
 
 #include <set>
+#include <vector>
 
 #include "base/statistics.hh"
 #include "mem/mem_object.hh"
@@ -65,8 +66,11 @@ class GarnetSyntheticTraffic : public MemObject
     GarnetSyntheticTraffic(const Params *p);
 
     virtual void init();
+    void regStats() override;
+    void resetStats() override;
 
-    // main simulation loop (one cycle)
+    // main simulation loop; runs only on injection cycles and at the end
+    // of the run
     void tick();
 
     virtual BaseMasterPort &getMasterPort(const std::string &if_name,
@@ -82,6 +86,7 @@ class GarnetSyntheticTraffic : public MemObject
 
   protected:
     EventFunctionWrapper tickEvent;
+    EventFunctionWrapper deadlockCheckEvent;
 
     class CpuPort : public MasterPort
     {
@@ -122,7 +127,10 @@ class GarnetSyntheticTraffic : public MemObject
 
     unsigned blockSizeBits;
 
-    Tick noResponseCycles;
+    // requests sent but not yet answered, and the cycle of the last
+    // response (or of the send that started the current wait)
+    int numPacketsOutstanding;
+    Cycles lastProgressCycle;
 
     int numDestinations;
     Tick simCycles;
@@ -137,6 +145,46 @@ class GarnetSyntheticTraffic : public MemObject
     double injRate;
     int injVnet;
     int precision;
+    // per-cycle injection probability, and the tick of the next
+    // injection (MaxTick if this tester never injects again)
+    double injProb;
+    Tick nextInjectTick;
+
+    // mesh shape used by the coordinate-based traffic patterns
+    int meshRows;
+    int meshCols;
+    // destination of a permutation pattern, computed once (-1 otherwise)
+    int permDest;
+
+    // hotspot overlay: this fraction of packets goes to hotspotNodes
+    std::vector<int> hotspotNodes;
+    double hotspotFraction;
+
+    // two-state MMPP (on/off) injection; disabled if burstOnCycles is 0
+    double burstOnCycles;
+    double burstOffCycles;
+    bool burstOn;
+    Cycles burstEndCycle;
+
+    // fraction of data (multi-flit) packets; < 0 picks vnets uniformly
+    double dataFraction;
+
+    // closed loop: at most maxOutstanding requests wait for a reply
+    // (0 is open loop). Each outstanding request uses a distinct tag in
+    // the address bits above the destination, so the sequencer does not
+    // coalesce requests to the same destination.
+    int maxOutstanding;
+    bool injectionBlocked;
+    int tagShift;
+    std::vector<int> freeTags;
+    std::vector<Cycles> tagIssueCycle;
+
+    Cycles statsStartCycle;
+    Stats::Scalar numTransactions;
+    Stats::Scalar totalRoundTrip;
+    Stats::Histogram roundTripHist;
+    Stats::Formula avgRoundTrip;
+    Stats::Value transactionRate;
 
     const Cycles responseLimit;
 
@@ -144,6 +192,12 @@ class GarnetSyntheticTraffic : public MemObject
 
     void completeRequest(PacketPtr pkt);
 
+    void scheduleNextInjection(Cycles first_trial);
+    double getTransactionRate() const;
+    uint64_t geometricTrials(double p);
+    int permutationDest(int source);
+    void checkDeadlock();
+
     void generatePkt();
     void sendPkt(PacketPtr pkt);
     void initTrafficType();
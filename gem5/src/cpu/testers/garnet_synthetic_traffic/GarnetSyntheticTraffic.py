@@ -56,3 +56,22 @@ class GarnetSyntheticTraffic(MemObject):
     test = MasterPort("Port to the memory system to test")
     system = Param.System(Parent.any, "System we belong to")
     sim_type = Param.Int(1, "type of simulation done in garnet")
+    mesh_rows = Param.Int(0, "rows of the mesh the destinations form; \
+                              0 assumes a square mesh")
+    hotspot_nodes = VectorParam.Int([], "hotspot destinations")
+    hotspot_fraction = Param.Float(0.0, "fraction of packets sent to a \
+                                         random hotspot node")
+    burst_on_cycles = Param.Float(0.0, "mean length of an injection \
+                                        burst (on/off MMPP); 0 disables. \
+                                        At most one packet is injected per \
+                                        cycle, so the mean rate is capped at \
+                                        on / (on + off)")
+    burst_off_cycles = Param.Float(0.0, "mean gap between injection \
+                                         bursts")
+    data_fraction = Param.Float(-1.0, "fraction of data (multi-flit) \
+                                       packets when inj_vnet is -1; \
+                                       negative picks vnets uniformly")
+    max_outstanding = Param.Int(0, "closed loop: inject only requests \
+                                    (vnet 0) and keep at most this many \
+                                    waiting for their reply; \
+                                    0 is open loop")
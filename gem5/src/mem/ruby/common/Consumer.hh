@@ -37,8 +37,10 @@
 
 #include <iostream>
 #include <set>
+#include <typeinfo>
 
 #include "sim/clocked_object.hh"
+#include "sim/eventq.hh"
 
 class Consumer
 {
@@ -78,6 +80,32 @@ class Consumer
     ClockedObject *em;
 };
 
+/**
+ * One-shot wakeup of a Consumer. Charged to the consumer's own class by
+ * the host-time profiler, so Routers, NetworkInterfaces, links and
+ * controllers show up separately instead of as one "Consumer Event".
+ */
+class ConsumerEvent : public Event
+{
+  public:
+    ConsumerEvent(Consumer *consumer)
+        : Event(Default_Pri, AutoDelete), m_consumer(consumer)
+    {
+    }
+
+    void process() { m_consumer->wakeup(); }
+    const char *description() const { return "Consumer Event"; }
+
+    const std::type_info &
+    profileClass() const
+    {
+        return typeid(*m_consumer);
+    }
+
+  private:
+    Consumer *m_consumer;
+};
+
 inline std::ostream&
 operator<<(std::ostream& out, const Consumer& obj)
 {
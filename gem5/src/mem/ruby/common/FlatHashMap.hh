@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_COMMON_FLATHASHMAP_HH__
+#define __MEM_RUBY_COMMON_FLATHASHMAP_HH__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+/**
+ * A fixed-capacity open-addressing hash map for the small, hot lookup
+ * tables in Ruby (TBE tables, sequencer request tables). The number of
+ * live entries is bounded when the table is built, so all storage is
+ * allocated once: a slot array probed linearly, at most half full, and
+ * an entry pool the slots index into. Deletion shifts later slots of the
+ * probe run back instead of leaving tombstones, and since only the
+ * slots move, pointers to values stay valid until their own key is
+ * erased, as with std::unordered_map.
+ *
+ * The interface is the subset of std::unordered_map the callers use.
+ * Erasing invalidates iterators; inserting does not. Inserting beyond
+ * the capacity is a fatal error.
+ */
+template <class Key, class Value, class Hash = std::hash<Key>>
+class FlatHashMap
+{
+  public:
+    typedef Key key_type;
+    typedef Value mapped_type;
+    typedef std::pair<Key, Value> value_type;
+
+  private:
+    static const uint32_t emptySlot = std::numeric_limits<uint32_t>::max();
+
+    struct Slot
+    {
+        Key key;
+        uint32_t entry;
+    };
+
+    template <class Map, class Ref>
+    class IteratorBase
+    {
+      public:
+        IteratorBase(Map *map, std::size_t slot)
+            : map(map), slot(slot)
+        {
+            skipEmpty();
+        }
+
+        Ref operator*() const
+        { return map->entries[map->slots[slot].entry]; }
+
+        typename std::remove_reference<Ref>::type *
+        operator->() const { return &**this; }
+
+        IteratorBase &
+        operator++()
+        {
+            ++slot;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const IteratorBase &rhs) const
+        { return slot == rhs.slot && map == rhs.map; }
+        bool operator!=(const IteratorBase &rhs) const
+        { return !(*this == rhs); }
+
+      private:
+        void
+        skipEmpty()
+        {
+            while (slot < map->slots.size() &&
+                   map->slots[slot].entry == emptySlot)
+                ++slot;
+        }
+
+        Map *map;
+        std::size_t slot;
+
+        friend class FlatHashMap;
+    };
+
+  public:
+    typedef IteratorBase<FlatHashMap, value_type &> iterator;
+    typedef IteratorBase<const FlatHashMap, const value_type &>
+        const_iterator;
+
+    explicit FlatHashMap(std::size_t capacity)
+        : entries(capacity), numEntries(0)
+    {
+        fatal_if(capacity >= emptySlot,
+                 "FlatHashMap capacity %d is too large\n", capacity);
+
+        std::size_t num_slots = ceilPow2(2 * std::max<std::size_t>(
+                                             capacity, 1));
+        slots.resize(num_slots, Slot{Key(), emptySlot});
+        slotMask = num_slots - 1;
+        hashShift = 64 - ceilLog2(num_slots);
+
+        freeEntries.reserve(capacity);
+        clear();
+    }
+
+    std::size_t size() const { return numEntries; }
+    bool empty() const { return numEntries == 0; }
+    std::size_t capacity() const { return entries.size(); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slots.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const
+    { return const_iterator(this, slots.size()); }
+
+    iterator
+    find(const Key &key)
+    {
+        std::size_t i = probe(key);
+        return slots[i].entry == emptySlot ? end() : iterator(this, i);
+    }
+
+    const_iterator
+    find(const Key &key) const
+    {
+        std::size_t i = probe(key);
+        return slots[i].entry == emptySlot ? end() : const_iterator(this, i);
+    }
+
+    std::size_t
+    count(const Key &key) const
+    {
+        return slots[probe(key)].entry != emptySlot;
+    }
+
+    std::pair<iterator, bool>
+    insert(const value_type &value)
+    {
+        std::size_t i = probe(value.first);
+        if (slots[i].entry != emptySlot)
+            return std::make_pair(iterator(this, i), false);
+
+        fatal_if(freeEntries.empty(),
+                 "FlatHashMap is full (capacity %d)\n", entries.size());
+
+        uint32_t entry = freeEntries.back();
+        freeEntries.pop_back();
+        entries[entry] = value;
+        slots[i].key = value.first;
+        slots[i].entry = entry;
+        ++numEntries;
+
+        return std::make_pair(iterator(this, i), true);
+    }
+
+    Value &
+    operator[](const Key &key)
+    {
+        return insert(value_type(key, Value())).first->second;
+    }
+
+    void erase(iterator pos) { eraseSlot(pos.slot); }
+
+    std::size_t
+    erase(const Key &key)
+    {
+        std::size_t i = probe(key);
+        if (slots[i].entry == emptySlot)
+            return 0;
+        eraseSlot(i);
+        return 1;
+    }
+
+    void
+    clear()
+    {
+        for (auto &slot : slots)
+            slot.entry = emptySlot;
+        for (auto &entry : entries)
+            entry = value_type();
+
+        freeEntries.clear();
+        for (std::size_t i = entries.size(); i > 0; --i)
+            freeEntries.push_back(i - 1);
+        numEntries = 0;
+    }
+
+  private:
+    std::size_t
+    homeSlot(const Key &key) const
+    {
+        // Fibonacci hashing: line addresses have their low bits clear,
+        // so take the well-mixed high bits of the product instead.
+        uint64_t h = static_cast<uint64_t>(Hash()(key));
+        return (h * 0x9e3779b97f4a7c15ULL) >> hashShift;
+    }
+
+    /**
+     * Return the slot holding key, or the empty slot that ends its
+     * probe run. The table is never more than half full, so an empty
+     * slot always exists.
+     */
+    std::size_t
+    probe(const Key &key) const
+    {
+        std::size_t i = homeSlot(key);
+        while (slots[i].entry != emptySlot && !(slots[i].key == key))
+            i = (i + 1) & slotMask;
+        return i;
+    }
+
+    void
+    eraseSlot(std::size_t hole)
+    {
+        uint32_t entry = slots[hole].entry;
+        entries[entry] = value_type();
+        freeEntries.push_back(entry);
+        --numEntries;
+
+        // Backward-shift deletion: walk the rest of the probe run and
+        // pull back every slot whose home is not between the hole and
+        // its current position, so lookups never need tombstones.
+        std::size_t i = hole;
+        while (true) {
+            i = (i + 1) & slotMask;
+            if (slots[i].entry == emptySlot)
+                break;
+
+            std::size_t home = homeSlot(slots[i].key);
+            if (((i - home) & slotMask) >= ((i - hole) & slotMask)) {
+                slots[hole] = slots[i];
+                hole = i;
+            }
+        }
+        slots[hole].entry = emptySlot;
+    }
+
+    std::vector<Slot> slots;
+    std::vector<value_type> entries;
+    std::vector<uint32_t> freeEntries;
+    std::size_t numEntries;
+    std::size_t slotMask;
+    int hashShift;
+};
+
+#endif // __MEM_RUBY_COMMON_FLATHASHMAP_HH__
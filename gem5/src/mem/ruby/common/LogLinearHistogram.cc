@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/common/LogLinearHistogram.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "base/intmath.hh"
+
+using namespace std;
+
+LogLinearHistogram::LogLinearHistogram(int sub_bucket_bits)
+    : m_sub_bucket_bits(sub_bucket_bits)
+{
+    assert(sub_bucket_bits >= 1 && sub_bucket_bits < 32);
+    clear();
+}
+
+void
+LogLinearHistogram::clear()
+{
+    m_data.clear();
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+    m_sum = 0;
+}
+
+// Bucket layout with S = m_sub_bucket_bits and H = 2^(S-1):
+//   [0, 2^S)        one bucket per value (index = value)
+//   [2^k, 2^(k+1))  H buckets of width 2^(k-S+1), for k >= S
+// A value v >= 2^S with most significant bit k is shifted right by
+// e = k - S + 1, leaving a mantissa m in [H, 2H); its index is
+// e * H + m, which continues the exact range without gaps.
+int
+LogLinearHistogram::bucketIndex(uint64_t value) const
+{
+    uint64_t exact = 1ULL << m_sub_bucket_bits;
+    if (value < exact)
+        return value;
+
+    int e = floorLog2(value) - m_sub_bucket_bits + 1;
+    uint64_t half = exact >> 1;
+    return e * half + (value >> e);
+}
+
+uint64_t
+LogLinearHistogram::bucketUpperBound(int index) const
+{
+    uint64_t exact = 1ULL << m_sub_bucket_bits;
+    if (index < (int) exact)
+        return index;
+
+    uint64_t half = exact >> 1;
+    int e = index / half - 1;
+    uint64_t m = index - e * half;
+    return ((m + 1) << e) - 1;
+}
+
+void
+LogLinearHistogram::add(uint64_t value)
+{
+    int index = bucketIndex(value);
+    if (index >= (int) m_data.size())
+        m_data.resize(index + 1, 0);
+    m_data[index]++;
+
+    if (m_count == 0 || value < m_min)
+        m_min = value;
+    if (value > m_max)
+        m_max = value;
+    m_count++;
+    m_sum += value;
+}
+
+void
+LogLinearHistogram::add(const LogLinearHistogram& hist)
+{
+    assert(hist.m_sub_bucket_bits == m_sub_bucket_bits);
+    if (hist.m_count == 0)
+        return;
+
+    if (hist.m_data.size() > m_data.size())
+        m_data.resize(hist.m_data.size(), 0);
+    for (int i = 0; i < (int) hist.m_data.size(); i++)
+        m_data[i] += hist.m_data[i];
+
+    if (m_count == 0 || hist.m_min < m_min)
+        m_min = hist.m_min;
+    m_max = max(m_max, hist.m_max);
+    m_count += hist.m_count;
+    m_sum += hist.m_sum;
+}
+
+double
+LogLinearHistogram::getMean() const
+{
+    return m_count ? m_sum / m_count : 0.0;
+}
+
+uint64_t
+LogLinearHistogram::percentile(double pct) const
+{
+    if (m_count == 0)
+        return 0;
+
+    pct = min(max(pct, 0.0), 100.0);
+    uint64_t rank = (uint64_t) ceil(pct / 100.0 * m_count);
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < (int) m_data.size(); i++) {
+        seen += m_data[i];
+        if (seen >= rank)
+            return min(bucketUpperBound(i), m_max);
+    }
+    return m_max;
+}
+
+void
+LogLinearHistogram::print(std::ostream& out) const
+{
+    out << "[count: " << m_count << " min: " << getMin()
+        << " mean: " << getMean() << " max: " << m_max
+        << " p50: " << percentile(50.0)
+        << " p99: " << percentile(99.0)
+        << " p99.9: " << percentile(99.9) << "]";
+}
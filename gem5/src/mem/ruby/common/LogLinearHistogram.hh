@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_COMMON_LOGLINEARHISTOGRAM_HH__
+#define __MEM_RUBY_COMMON_LOGLINEARHISTOGRAM_HH__
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+/*
+ * Log-linear (HDR-style) histogram of non-negative integer samples.
+ * Values below 2^sub_bucket_bits are counted exactly. Above that, every
+ * power-of-two range is split into 2^(sub_bucket_bits - 1) equal buckets,
+ * so a bucket never spans more than 2^-(sub_bucket_bits - 1) of its
+ * value. Recording is O(1); the bucket array grows only up to the bucket
+ * of the largest sample, so memory is bounded by the value range
+ * (at most 64 * 2^(sub_bucket_bits - 1) buckets).
+ */
+class LogLinearHistogram
+{
+  public:
+    explicit LogLinearHistogram(int sub_bucket_bits = 7);
+
+    void add(uint64_t value);
+    void add(const LogLinearHistogram& hist);
+    void clear();
+
+    uint64_t size() const { return m_count; }
+    uint64_t getMin() const { return m_count ? m_min : 0; }
+    uint64_t getMax() const { return m_max; }
+    double getMean() const;
+
+    // Smallest recorded bucket value such that at least pct percent of
+    // the samples are <= it; exact below 2^sub_bucket_bits, otherwise
+    // the upper bound of the bucket (capped at the largest sample).
+    uint64_t percentile(double pct) const;
+
+    void print(std::ostream& out) const;
+
+  private:
+    int bucketIndex(uint64_t value) const;
+    uint64_t bucketUpperBound(int index) const;
+
+    int m_sub_bucket_bits;
+    std::vector<uint64_t> m_data;
+    uint64_t m_count;
+    uint64_t m_min;
+    uint64_t m_max;
+    double m_sum;
+};
+
+inline std::ostream&
+operator<<(std::ostream& out, const LogLinearHistogram& obj)
+{
+    obj.print(out);
+    out << std::flush;
+    return out;
+}
+
+#endif // __MEM_RUBY_COMMON_LOGLINEARHISTOGRAM_HH__
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <unordered_map>
+
+#include "base/types.hh"
+#include "mem/ruby/common/FlatHashMap.hh"
+
+typedef FlatHashMap<Addr, int> Map;
+
+namespace {
+
+// Sends every key to the same home slot so all of them share one probe run.
+struct CollidingHash
+{
+    std::size_t operator()(Addr) const { return 0; }
+};
+
+// Collect the contents through iteration into an ordered map so they can
+// be compared with a reference container.
+template <class M>
+std::map<Addr, int>
+contents(const M &map)
+{
+    std::map<Addr, int> out;
+    for (auto i = map.begin(); i != map.end(); ++i)
+        out[i->first] = i->second;
+    return out;
+}
+
+} // anonymous namespace
+
+TEST(FlatHashMapTest, Empty)
+{
+    Map map(16);
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(0U, map.size());
+    EXPECT_EQ(16U, map.capacity());
+    EXPECT_TRUE(map.begin() == map.end());
+    EXPECT_TRUE(map.find(0x40) == map.end());
+    EXPECT_EQ(0U, map.count(0x40));
+    EXPECT_EQ(0U, map.erase(0x40));
+}
+
+TEST(FlatHashMapTest, InsertFindErase)
+{
+    Map map(4);
+
+    auto r = map.insert(Map::value_type(0x1000, 1));
+    EXPECT_TRUE(r.second);
+    EXPECT_EQ(0x1000U, r.first->first);
+    EXPECT_EQ(1, r.first->second);
+
+    // A second insert of the same key leaves the old value alone.
+    r = map.insert(Map::value_type(0x1000, 2));
+    EXPECT_FALSE(r.second);
+    EXPECT_EQ(1, r.first->second);
+    EXPECT_EQ(1U, map.size());
+
+    map[0x2000] = 3;
+    EXPECT_EQ(2U, map.size());
+    EXPECT_EQ(1U, map.count(0x2000));
+    EXPECT_EQ(3, map.find(0x2000)->second);
+
+    map.erase(map.find(0x1000));
+    EXPECT_EQ(0U, map.count(0x1000));
+    EXPECT_EQ(1U, map.erase(0x2000));
+    EXPECT_TRUE(map.empty());
+}
+
+// The table never grows, but every slot of the pool can be used and
+// reused.
+TEST(FlatHashMapTest, FillToCapacity)
+{
+    Map map(8);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 8; i++)
+            EXPECT_TRUE(map.insert(Map::value_type(i * 64, i)).second);
+        EXPECT_EQ(8U, map.size());
+        for (int i = 0; i < 8; i++)
+            EXPECT_EQ(i, map.find(i * 64)->second);
+        map.clear();
+        EXPECT_TRUE(map.empty());
+    }
+}
+
+// Values never move, so a pointer into the map survives other keys being
+// inserted and erased.
+TEST(FlatHashMapTest, PointerStability)
+{
+    Map map(32);
+    for (int i = 0; i < 32; i++)
+        map[i * 64] = i;
+
+    int *p = &map.find(17 * 64)->second;
+    for (int i = 0; i < 32; i++) {
+        if (i != 17)
+            map.erase(i * 64);
+    }
+    for (int i = 100; i < 131; i++)
+        map[i * 64] = i;
+
+    EXPECT_EQ(p, &map.find(17 * 64)->second);
+    EXPECT_EQ(17, *p);
+}
+
+// Erasing from the middle of one long probe run must shift the rest back
+// so that every remaining key is still reachable.
+TEST(FlatHashMapTest, BackwardShiftDeletion)
+{
+    FlatHashMap<Addr, int, CollidingHash> map(16);
+    for (int i = 0; i < 16; i++)
+        map[i * 64] = i;
+
+    for (int i = 0; i < 16; i += 3)
+        EXPECT_EQ(1U, map.erase(i * 64));
+
+    for (int i = 0; i < 16; i++) {
+        if (i % 3 == 0) {
+            EXPECT_EQ(0U, map.count(i * 64));
+        } else {
+            ASSERT_EQ(1U, map.count(i * 64));
+            EXPECT_EQ(i, map.find(i * 64)->second);
+        }
+    }
+}
+
+// Run a random mix of operations on line addresses and check the result
+// against std::unordered_map after every step.
+TEST(FlatHashMapTest, MatchesUnorderedMap)
+{
+    const std::size_t capacity = 64;
+    Map map(capacity);
+    std::unordered_map<Addr, int> ref;
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> op_dist(0, 2);
+    std::uniform_int_distribution<Addr> key_dist(0, 255);
+
+    for (int step = 0; step < 20000; step++) {
+        Addr key = key_dist(rng) << 6;
+        switch (op_dist(rng)) {
+          case 0:
+            if (ref.size() < capacity || ref.count(key)) {
+                auto r = map.insert(Map::value_type(key, step));
+                auto e = ref.insert(std::make_pair(key, step));
+                ASSERT_EQ(e.second, r.second);
+                ASSERT_EQ(e.first->second, r.first->second);
+            }
+            break;
+          case 1:
+            ASSERT_EQ(ref.erase(key), map.erase(key));
+            break;
+          default:
+            ASSERT_EQ(ref.count(key), map.count(key));
+            if (ref.count(key)) {
+                ASSERT_EQ(ref[key], map.find(key)->second);
+            }
+            break;
+        }
+        ASSERT_EQ(ref.size(), map.size());
+    }
+
+    std::map<Addr, int> expected(ref.begin(), ref.end());
+    EXPECT_EQ(expected, contents(map));
+}
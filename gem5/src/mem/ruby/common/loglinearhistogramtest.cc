@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mem/ruby/common/LogLinearHistogram.hh"
+
+TEST(LogLinearHistogramTest, Empty)
+{
+    LogLinearHistogram hist;
+    EXPECT_EQ(0U, hist.size());
+    EXPECT_EQ(0U, hist.getMax());
+    EXPECT_EQ(0U, hist.percentile(50.0));
+}
+
+// Values below 2^sub_bucket_bits are recorded exactly.
+TEST(LogLinearHistogramTest, ExactRange)
+{
+    LogLinearHistogram hist(7);
+    for (uint64_t v = 1; v <= 100; v++)
+        hist.add(v);
+
+    EXPECT_EQ(100U, hist.size());
+    EXPECT_EQ(1U, hist.getMin());
+    EXPECT_EQ(100U, hist.getMax());
+    EXPECT_DOUBLE_EQ(50.5, hist.getMean());
+    EXPECT_EQ(50U, hist.percentile(50.0));
+    EXPECT_EQ(99U, hist.percentile(99.0));
+    EXPECT_EQ(100U, hist.percentile(99.9));
+    EXPECT_EQ(100U, hist.percentile(100.0));
+    EXPECT_EQ(1U, hist.percentile(0.0));
+}
+
+// Above the exact range a percentile is never below the true value and
+// exceeds it by at most the bucket width.
+TEST(LogLinearHistogramTest, RelativeError)
+{
+    const int bits = 5;
+    LogLinearHistogram hist(bits);
+    std::vector<uint64_t> values;
+    for (uint64_t v = 0; v < 200000; v += 7) {
+        hist.add(v);
+        values.push_back(v);
+    }
+
+    double max_error = 1.0 / (1 << (bits - 1));
+    const double pcts[] = { 10.0, 50.0, 90.0, 99.0, 99.9 };
+    for (double pct : pcts) {
+        uint64_t rank = (uint64_t) ceil(pct / 100.0 * values.size());
+        uint64_t exact = values[rank - 1];
+        uint64_t approx = hist.percentile(pct);
+        EXPECT_GE(approx, exact);
+        EXPECT_LE(approx - exact, exact * max_error);
+    }
+}
+
+TEST(LogLinearHistogramTest, LargeValues)
+{
+    LogLinearHistogram hist;
+    hist.add(1ULL << 40);
+    hist.add((1ULL << 62) + 12345);
+    EXPECT_EQ(2U, hist.size());
+    EXPECT_EQ((1ULL << 62) + 12345, hist.percentile(100.0));
+    EXPECT_EQ(1ULL << 40, hist.getMin());
+}
+
+TEST(LogLinearHistogramTest, Merge)
+{
+    LogLinearHistogram a, b;
+    for (uint64_t v = 0; v < 1000; v++) {
+        if (v % 2)
+            a.add(v);
+        else
+            b.add(v);
+    }
+
+    LogLinearHistogram all;
+    for (uint64_t v = 0; v < 1000; v++)
+        all.add(v);
+
+    a.add(b);
+    EXPECT_EQ(all.size(), a.size());
+    EXPECT_EQ(all.getMin(), a.getMin());
+    EXPECT_EQ(all.getMax(), a.getMax());
+    EXPECT_EQ(all.percentile(50.0), a.percentile(50.0));
+    EXPECT_EQ(all.percentile(99.9), a.percentile(99.9));
+
+    a.clear();
+    EXPECT_EQ(0U, a.size());
+    EXPECT_EQ(0U, a.percentile(99.0));
+}
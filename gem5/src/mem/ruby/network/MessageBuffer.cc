@@ -41,7 +41,8 @@ using namespace std;
 using m5::stl_helpers::operator<<;
 
 MessageBuffer::MessageBuffer(const Params *p)
-    : SimObject(p), m_stall_map_size(0),
+    : SimObject(p), m_fifo_head(0), m_fifo_count(0),
+    m_last_wakeup_request(0), m_stall_map_size(0),
     m_max_size(p->buffer_size), m_time_last_time_size_checked(0),
     m_time_last_time_enqueue(0), m_time_last_time_pop(0),
     m_last_arrival_time(0), m_strict_fifo(p->ordered),
@@ -62,6 +63,70 @@ MessageBuffer::MessageBuffer(const Params *p)
     m_stall_time = 0;
 
     m_dequeue_callback = nullptr;
+
+    if (m_strict_fifo) {
+        // start with room for a full finite buffer
+        unsigned int capacity = 16;
+        while (capacity < m_max_size)
+            capacity *= 2;
+        m_fifo.resize(capacity);
+    }
+}
+
+void
+MessageBuffer::insertMsg(const MsgPtr &message)
+{
+    if (!m_strict_fifo) {
+        m_prio_heap.push_back(message);
+        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
+                  greater<MsgPtr>());
+        return;
+    }
+
+    if (m_fifo_count == m_fifo.size())
+        growFifo();
+
+    if (m_fifo_count > 0 && fifoAt(0) > message) {
+        // reanalyzed messages go in front of everything queued
+        m_fifo_head = (m_fifo_head - 1) & (m_fifo.size() - 1);
+        fifoAt(0) = message;
+        m_fifo_count++;
+        return;
+    }
+
+    // append, moving younger messages back if it arrives earlier
+    unsigned int pos = m_fifo_count;
+    while (pos > 0 && fifoAt(pos - 1) > message) {
+        fifoAt(pos) = std::move(fifoAt(pos - 1));
+        pos--;
+    }
+    fifoAt(pos) = message;
+    m_fifo_count++;
+}
+
+void
+MessageBuffer::popHead()
+{
+    if (!m_strict_fifo) {
+        pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+        m_prio_heap.pop_back();
+        return;
+    }
+
+    assert(m_fifo_count > 0);
+    fifoAt(0) = nullptr;
+    m_fifo_head = (m_fifo_head + 1) & (m_fifo.size() - 1);
+    m_fifo_count--;
+}
+
+void
+MessageBuffer::growFifo()
+{
+    std::vector<MsgPtr> fifo(m_fifo.size() * 2);
+    for (unsigned int i = 0; i < m_fifo_count; ++i)
+        fifo[i] = std::move(fifoAt(i));
+    m_fifo.swap(fifo);
+    m_fifo_head = 0;
 }
 
 unsigned int
@@ -69,7 +134,7 @@ MessageBuffer::getSize(Tick curTime)
 {
     if (m_time_last_time_size_checked != curTime) {
         m_time_last_time_size_checked = curTime;
-        m_size_last_time_size_checked = m_prio_heap.size();
+        m_size_last_time_size_checked = queuedMsgs();
     }
 
     return m_size_last_time_size_checked;
@@ -92,7 +157,7 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
 
     if (m_time_last_time_pop < current_time) {
         // no pops this cycle - heap size is correct
-        current_size = m_prio_heap.size();
+        current_size = queuedMsgs();
     } else {
         if (m_time_last_time_enqueue < current_time) {
             // no enqueues this cycle - m_size_at_cycle_start is correct
@@ -110,7 +175,7 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
     } else {
         DPRINTF(RubyQueue, "n: %d, current_size: %d, heap size: %d, "
                 "m_max_size: %d\n",
-                n, current_size, m_prio_heap.size(), m_max_size);
+                n, current_size, queuedMsgs(), m_max_size);
         m_not_avail_count++;
         return false;
     }
@@ -120,7 +185,7 @@ const Message*
 MessageBuffer::peek() const
 {
     DPRINTF(RubyQueue, "Peeking at head of queue.\n");
-    const Message* msg_ptr = m_prio_heap.front().get();
+    const Message* msg_ptr = headMsg().get();
     assert(msg_ptr);
 
     DPRINTF(RubyQueue, "Message: %s\n", (*msg_ptr));
@@ -199,17 +264,21 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
     msg_ptr->setMsgCounter(m_msg_counter);
 
     // Insert the message into the priority heap
-    m_prio_heap.push_back(message);
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    insertMsg(message);
     // Increment the number of messages statistic
     m_buf_msgs++;
 
     DPRINTF(RubyQueue, "Enqueue arrival_time: %lld, Message: %s\n",
             arrival_time, *(message.get()));
 
-    // Schedule the wakeup
+    // Schedule the wakeup. The arrival time is always in the future, so
+    // a wakeup already requested for it is still pending and messages
+    // arriving together only need to ask the consumer once.
     assert(m_consumer != NULL);
-    m_consumer->scheduleEventAbsolute(arrival_time);
+    if (arrival_time != m_last_wakeup_request) {
+        m_consumer->scheduleEventAbsolute(arrival_time);
+        m_last_wakeup_request = arrival_time;
+    }
     m_consumer->storeEventInfo(m_vnet_id);
 }
 
@@ -220,7 +289,7 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     assert(isReady(current_time));
 
     // get MsgPtr of the message about to be dequeued
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = headMsg();
 
     // get the delay cycles
     message->updateDelayedTicks(current_time);
@@ -231,12 +300,11 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     // record previous size and time so the current buffer size isn't
     // adjusted until schd cycle
     if (m_time_last_time_pop < current_time) {
-        m_size_at_cycle_start = m_prio_heap.size();
+        m_size_at_cycle_start = queuedMsgs();
         m_time_last_time_pop = current_time;
     }
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
-    m_prio_heap.pop_back();
+    popHead();
     if (decrement_messages) {
         // If the message will be removed from the queue, decrement the
         // number of message in the queue.
@@ -267,6 +335,8 @@ void
 MessageBuffer::clear()
 {
     m_prio_heap.clear();
+    while (m_fifo_count > 0)
+        popHead();
 
     m_msg_counter = 0;
     m_time_last_time_enqueue = 0;
@@ -280,33 +350,29 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
 {
     DPRINTF(RubyQueue, "Recycling.\n");
     assert(isReady(current_time));
-    MsgPtr node = m_prio_heap.front();
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    MsgPtr node = headMsg();
+    popHead();
 
     Tick future_time = current_time + recycle_latency;
     node->setLastEnqueueTime(future_time);
 
-    m_prio_heap.back() = node;
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    insertMsg(node);
     m_consumer->scheduleEventAbsolute(future_time);
 }
 
 void
-MessageBuffer::reanalyzeList(list<MsgPtr> &lt, Tick schdTick)
+MessageBuffer::reanalyzeList(vector<MsgPtr> &lt, Tick schdTick)
 {
-    while (!lt.empty()) {
+    for (auto &m : lt) {
         m_msg_counter++;
-        MsgPtr m = lt.front();
         m->setLastEnqueueTime(schdTick);
         m->setMsgCounter(m_msg_counter);
 
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  greater<MsgPtr>());
+        insertMsg(m);
 
         m_consumer->scheduleEventAbsolute(schdTick);
-        lt.pop_front();
     }
+    lt.clear();
 }
 
 void
@@ -353,7 +419,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     DPRINTF(RubyQueue, "Stalling due to %#x\n", addr);
     assert(isReady(current_time));
     assert(getOffset(addr) == 0);
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = headMsg();
 
     // Since the message will just be moved to stall map, indicate that the
     // buffer should not decrement the m_buf_msgs statistic
@@ -377,16 +443,23 @@ MessageBuffer::print(ostream& out) const
         ccprintf(out, " consumer-yes ");
     }
 
-    vector<MsgPtr> copy(m_prio_heap);
-    sort_heap(copy.begin(), copy.end(), greater<MsgPtr>());
+    vector<MsgPtr> copy;
+    if (m_strict_fifo) {
+        // youngest first, as printed for the heap below
+        for (unsigned int i = m_fifo_count; i > 0; --i)
+            copy.push_back(fifoAt(i - 1));
+    } else {
+        copy = m_prio_heap;
+        sort_heap(copy.begin(), copy.end(), greater<MsgPtr>());
+    }
     ccprintf(out, "%s] %s", copy, name());
 }
 
 bool
 MessageBuffer::isReady(Tick current_time) const
 {
-    return ((m_prio_heap.size() > 0) &&
-        (m_prio_heap.front()->getLastEnqueueTime() <= current_time));
+    return ((queuedMsgs() > 0) &&
+        (headMsg()->getLastEnqueueTime() <= current_time));
 }
 
 void
@@ -429,10 +502,10 @@ MessageBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    // Check the priority heap and write any messages that may
-    // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].get();
+    // Check the queued messages and write any that may correspond
+    // to the address in the packet.
+    for (unsigned int i = 0; i < queuedMsgs(); ++i) {
+        Message *msg = m_strict_fifo ? fifoAt(i).get() : m_prio_heap[i].get();
         if (msg->functionalWrite(pkt)) {
             num_functional_writes++;
         }
@@ -444,7 +517,7 @@ MessageBuffer::functionalWrite(Packet *pkt)
          map_iter != m_stall_msg_map.end();
          ++map_iter) {
 
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
+        for (std::vector<MsgPtr>::iterator it = (map_iter->second).begin();
             it != (map_iter->second).end(); ++it) {
 
             Message *msg = (*it).get();
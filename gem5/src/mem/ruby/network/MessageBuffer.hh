@@ -38,6 +38,7 @@
 #include <cassert>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -66,10 +67,8 @@ class MessageBuffer : public SimObject
     void
     delayHead(Tick current_time, Tick delta)
     {
-        MsgPtr m = m_prio_heap.front();
-        std::pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      std::greater<MsgPtr>());
-        m_prio_heap.pop_back();
+        MsgPtr m = headMsg();
+        popHead();
         enqueue(m, current_time, delta);
     }
 
@@ -95,7 +94,7 @@ class MessageBuffer : public SimObject
     //! message queue.  The function assumes that the queue is nonempty.
     const Message* peek() const;
 
-    const MsgPtr &peekMsgPtr() const { return m_prio_heap.front(); }
+    const MsgPtr &peekMsgPtr() const { return headMsg(); }
 
     void enqueue(MsgPtr message, Tick curTime, Tick delta);
 
@@ -107,7 +106,7 @@ class MessageBuffer : public SimObject
     void unregisterDequeueCallback();
 
     void recycle(Tick current_time, Tick recycle_latency);
-    bool isEmpty() const { return m_prio_heap.size() == 0; }
+    bool isEmpty() const { return queuedMsgs() == 0; }
     bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
     unsigned int getStallMapSize() { return m_stall_msg_map.size(); }
 
@@ -129,7 +128,37 @@ class MessageBuffer : public SimObject
     uint32_t functionalWrite(Packet *pkt);
 
   private:
-    void reanalyzeList(std::list<MsgPtr> &, Tick);
+    void reanalyzeList(std::vector<MsgPtr> &, Tick);
+
+    //! Queue primitives. Ordered buffers keep their messages in the
+    //! sorted ring m_fifo, all other buffers in the m_prio_heap.
+    void insertMsg(const MsgPtr &message);
+    void popHead();
+    void growFifo();
+
+    const MsgPtr &
+    headMsg() const
+    {
+        return m_strict_fifo ? fifoAt(0) : m_prio_heap.front();
+    }
+
+    unsigned int
+    queuedMsgs() const
+    {
+        return m_strict_fifo ? m_fifo_count : m_prio_heap.size();
+    }
+
+    const MsgPtr &
+    fifoAt(unsigned int i) const
+    {
+        return m_fifo[(m_fifo_head + i) & (m_fifo.size() - 1)];
+    }
+
+    MsgPtr &
+    fifoAt(unsigned int i)
+    {
+        return m_fifo[(m_fifo_head + i) & (m_fifo.size() - 1)];
+    }
 
   private:
     // Data Members (m_ prefix)
@@ -137,11 +166,28 @@ class MessageBuffer : public SimObject
     Consumer* m_consumer;
     std::vector<MsgPtr> m_prio_heap;
 
+    /**
+     * Ring of messages sorted by arrival time, used instead of the
+     * m_prio_heap when the buffer is ordered. Messages of an ordered
+     * buffer arrive in order, so enqueue and dequeue are O(1) and the
+     * ring never allocates once it has reached the buffer's working
+     * size. Recycled and reanalyzed messages are put back at their
+     * sorted position. The capacity is a power of two.
+     */
+    std::vector<MsgPtr> m_fifo;
+    unsigned int m_fifo_head;
+    unsigned int m_fifo_count;
+
+    //! Last wakeup requested from the consumer by enqueue()
+    Tick m_last_wakeup_request;
+
     std::function<void()> m_dequeue_callback;
 
     // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map<Addr, std::list<MsgPtr> > StallMsgMapType;
+    // sorted and ensures a well-defined iteration order. Each line
+    // keeps its messages in a vector, which avoids allocating a list
+    // node per stalled message.
+    typedef std::map<Addr, std::vector<MsgPtr> > StallMsgMapType;
 
     /**
      * A map from line addresses to lists of stalled messages for that line.
@@ -46,8 +46,12 @@ enum flit_stage {I_, VA_, SA_, ST_, LT_, NUM_FLIT_STAGE_};
 enum link_type { EXT_IN_, EXT_OUT_, INT_, NUM_LINK_TYPES_ };
 enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, RANDOM_ = 2, ADAPT_RAND_ = 3,
                        WestFirst_ = 4, ADAPT_WestFirst_ = 5,
-                       DEFLECTION_= 6, CUSTOM_ = 7, NUM_ROUTING_ALGORITHM_ };
-enum policy { MINIMAL_ = 1, NON_MINIMAL_ = 2, NUM_POLICY_ };
+                       DEFLECTION_= 6, CUSTOM_ = 7, EXPRESS_XY_ = 8,
+                       NUM_ROUTING_ALGORITHM_ };
+enum policy { MINIMAL_ = 1, NON_MINIMAL_ = 2, SPIN_ = 3, NUM_POLICY_ };
+enum SaArbitration { SA_ROUND_ROBIN_ = 0, SA_OLDEST_FIRST_ = 1,
+                     SA_HOP_COUNT_ = 2, SA_STARVATION_ = 3,
+                     NUM_SA_ARBITRATION_ };
 enum TDM {_1 = 1, _2 = 2, _4 = 4, _8 = 8, _16 = 16, _32 = 32, _64 = 64,
          _128 = 128, _256 = 256, _512 = 512, _1024 = 1024 };
 
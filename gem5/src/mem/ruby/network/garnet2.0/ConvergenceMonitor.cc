@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet2.0/ConvergenceMonitor.hh"
+
+#include <cmath>
+#include <iostream>
+
+#include "base/logging.hh"
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "sim/sim_exit.hh"
+
+using namespace std;
+
+// two-sided 97.5% quantile of Student's t, df = 1..30
+static const double t_975[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+static double
+student_t_975(int df)
+{
+    assert(df >= 1);
+    if (df <= 30)
+        return t_975[df - 1];
+    // Cornish-Fisher expansion around the normal quantile
+    const double z = 1.95996;
+    return z + (z * z * z + z) / (4.0 * df);
+}
+
+// Mean of 'values' and the relative 95% half-width of its confidence
+// interval; the half-width is infinite while it cannot be estimated.
+static void
+confidence_interval(const vector<double> &values, double &mean,
+                    double &rel_half_width)
+{
+    int n = values.size();
+    mean = 0.0;
+    for (int i = 0; i < n; i++)
+        mean += values[i];
+    mean /= n;
+
+    rel_half_width = INFINITY;
+    if (n < 2 || mean <= 0.0)
+        return;
+
+    double var = 0.0;
+    for (int i = 0; i < n; i++)
+        var += (values[i] - mean) * (values[i] - mean);
+    var /= (n - 1);
+
+    rel_half_width = student_t_975(n - 1) * sqrt(var / n) / mean;
+}
+
+ConvergenceMonitor::ConvergenceMonitor(GarnetNetwork *net_ptr, Cycles start,
+                                       Cycles batch_cycles, double target,
+                                       int min_batches)
+    : m_net_ptr(net_ptr), m_start(start), m_batch_cycles(batch_cycles),
+      m_target(target), m_min_batches(min_batches),
+      m_batch_event([this]{ close_batch(); }, "Garnet convergence batch"),
+      m_batch_start(0), m_cur_latency(0.0), m_cur_packets(0),
+      m_started(false), m_converged(false), m_latency_mean(0.0),
+      m_latency_half_width(INFINITY), m_throughput_mean(0.0),
+      m_throughput_half_width(INFINITY)
+{
+    fatal_if(m_batch_cycles == Cycles(0),
+             "ci_batch_cycles must be greater than 0\n");
+    fatal_if(!(m_target > 0.0), "ci_target must be greater than 0, got %f\n",
+             m_target);
+    // merging halves the batch count, which must not drop below the
+    // minimum needed to stop
+    fatal_if(m_min_batches < 2 || m_min_batches > MAX_BATCHES / 2,
+             "ci_min_batches must be between 2 and %d, got %d\n",
+             MAX_BATCHES / 2, m_min_batches);
+}
+
+ConvergenceMonitor::~ConvergenceMonitor()
+{
+    if (m_batch_event.scheduled())
+        m_net_ptr->deschedule(m_batch_event);
+}
+
+void
+ConvergenceMonitor::startup()
+{
+    m_net_ptr->schedule(m_batch_event, m_net_ptr->clockEdge(m_start));
+}
+
+void
+ConvergenceMonitor::start()
+{
+    // packets delivered during warmup are not part of any batch
+    m_started = true;
+    m_batch_start = m_net_ptr->curCycle();
+    m_cur_latency = 0.0;
+    m_cur_packets = 0;
+}
+
+void
+ConvergenceMonitor::close_batch()
+{
+    if (!m_started) {
+        start();
+        m_net_ptr->schedule(m_batch_event,
+                            m_net_ptr->clockEdge(m_batch_cycles));
+        return;
+    }
+
+    Cycles cur_cycle = m_net_ptr->curCycle();
+    // a batch needs at least one packet to have a latency mean;
+    // at very low load it is simply extended
+    if (m_cur_packets > 0) {
+        Batch batch;
+        batch.latency = m_cur_latency;
+        batch.packets = m_cur_packets;
+        batch.cycles = cur_cycle - m_batch_start;
+        m_batches.push_back(batch);
+
+        m_batch_start = cur_cycle;
+        m_cur_latency = 0.0;
+        m_cur_packets = 0;
+
+        if (m_batches.size() == (size_t) MAX_BATCHES)
+            merge_batches();
+
+        update_intervals();
+    }
+
+    if (m_batches.size() >= (size_t) m_min_batches &&
+        m_latency_half_width <= m_target &&
+        m_throughput_half_width <= m_target) {
+        m_converged = true;
+        cout << "latency and throughput converged after "
+             << m_batches.size() << " batches: latency "
+             << m_latency_mean << " +/- "
+             << m_latency_half_width * 100.0 << "%, throughput "
+             << m_throughput_mean << " +/- "
+             << m_throughput_half_width * 100.0 << "%" << endl;
+        exitSimLoop("Garnet latency and throughput confidence "
+                    "intervals converged");
+        return;
+    }
+
+    m_net_ptr->schedule(m_batch_event, m_net_ptr->clockEdge(m_batch_cycles));
+}
+
+void
+ConvergenceMonitor::merge_batches()
+{
+    int n = m_batches.size() / 2;
+    for (int i = 0; i < n; i++) {
+        Batch &a = m_batches[2 * i];
+        Batch &b = m_batches[2 * i + 1];
+        m_batches[i].latency = a.latency + b.latency;
+        m_batches[i].packets = a.packets + b.packets;
+        m_batches[i].cycles = a.cycles + b.cycles;
+    }
+    m_batches.resize(n);
+    m_batch_cycles = Cycles(m_batch_cycles * 2);
+}
+
+void
+ConvergenceMonitor::update_intervals()
+{
+    int num_nodes = m_net_ptr->getNumNodes();
+    vector<double> latency(m_batches.size());
+    vector<double> throughput(m_batches.size());
+
+    for (int i = 0; i < m_batches.size(); i++) {
+        latency[i] = m_batches[i].latency / m_batches[i].packets;
+        // accepted packets per node per cycle
+        throughput[i] = (double) m_batches[i].packets /
+                        ((double) m_batches[i].cycles * num_nodes);
+    }
+
+    confidence_interval(latency, m_latency_mean, m_latency_half_width);
+    confidence_interval(throughput, m_throughput_mean,
+                        m_throughput_half_width);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_CONVERGENCEMONITOR_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_CONVERGENCEMONITOR_HH__
+
+#include <vector>
+
+#include "base/types.hh"
+#include "sim/eventq.hh"
+
+class GarnetNetwork;
+
+/*
+ * Batch-means stopping rule for sim_type 3.
+ * After warmup, delivered packets are grouped into batches of
+ * 'batch_cycles' cycles. Once at least 'min_batches' batches are closed
+ * and the 95% confidence interval half-width of both the mean packet
+ * latency and the accepted throughput is within 'target' of the mean,
+ * the simulation exits. The number of batches kept is bounded: when it
+ * reaches MAX_BATCHES, adjacent batches are merged and the batch length
+ * doubles, which also reduces the correlation between batch means as
+ * the run gets longer.
+ */
+class ConvergenceMonitor
+{
+  public:
+    ConvergenceMonitor(GarnetNetwork *net_ptr, Cycles start,
+                       Cycles batch_cycles, double target,
+                       int min_batches);
+    ~ConvergenceMonitor();
+
+    // schedule the start of the first batch
+    void startup();
+
+    void record_packet(Cycles latency)
+    {
+        m_cur_latency += latency;
+        m_cur_packets++;
+    }
+
+    bool is_converged() const { return m_converged; }
+    int get_num_batches() const { return m_batches.size(); }
+    // mean and relative 95% CI half-width over the closed batches
+    double get_latency_mean() const { return m_latency_mean; }
+    double get_latency_half_width() const { return m_latency_half_width; }
+    double get_throughput_mean() const { return m_throughput_mean; }
+    double
+    get_throughput_half_width() const
+    {
+        return m_throughput_half_width;
+    }
+
+  private:
+    struct Batch
+    {
+        double latency;
+        uint64_t packets;
+        Cycles cycles;
+    };
+
+    static const int MAX_BATCHES = 64;
+
+    void start();
+    void close_batch();
+    void merge_batches();
+    void update_intervals();
+
+    GarnetNetwork *m_net_ptr;
+    Cycles m_start;
+    Cycles m_batch_cycles;
+    double m_target;
+    int m_min_batches;
+    EventFunctionWrapper m_batch_event;
+
+    std::vector<Batch> m_batches;
+    Cycles m_batch_start;
+    double m_cur_latency;
+    uint64_t m_cur_packets;
+    bool m_started;
+    bool m_converged;
+
+    double m_latency_mean;
+    double m_latency_half_width;
+    double m_throughput_mean;
+    double m_throughput_half_width;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_CONVERGENCEMONITOR_HH__
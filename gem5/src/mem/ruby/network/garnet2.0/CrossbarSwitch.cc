@@ -91,8 +91,16 @@ CrossbarSwitch::wakeup()
             t_flit->set_time(m_router->curCycle() + Cycles(1));
 
             // This will take care of waking up the Network Link
-            // in the next cycle
-            m_output_unit[outport]->insert_flit(t_flit);
+            // in the next cycle. A flit that bypasses downstream
+            // routers (SMART) goes straight to the output link of
+            // the last bypassed router.
+            OutputUnit *bypass_unit = t_flit->get_bypass_unit();
+            if (bypass_unit != NULL) {
+                t_flit->set_bypass_unit(NULL);
+                bypass_unit->insert_flit(t_flit);
+            } else {
+                m_output_unit[outport]->insert_flit(t_flit);
+            }
             m_switch_buffer[inport]->getTopFlit();
             m_crossbar_activity++;
         }
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_FLITBUFFERBASE_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_FLITBUFFERBASE_HH__
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/ruby/network/garnet2.0/CommonTypes.hh"
+
+/**
+ * Heap of flit pointers that hands out the flit with the earliest time
+ * first, and the lowest id among flits with the same time. It only needs
+ * get_time() and get_id() from the flit type.
+ */
+template <class Flit>
+class FlitHeap
+{
+  public:
+    static bool
+    greater(Flit *n1, Flit *n2)
+    {
+        if (n1->get_time() == n2->get_time()) {
+            //assert(n1->flit_id != n2->flit_id);
+            return (n1->get_id() > n2->get_id());
+        } else {
+            return (n1->get_time() > n2->get_time());
+        }
+    }
+
+    bool empty() const { return m_heap.empty(); }
+    std::size_t size() const { return m_heap.size(); }
+    Flit *top() const { return m_heap.front(); }
+
+    /** Flits in heap order, not in the order they leave. */
+    Flit *operator[](std::size_t i) const { return m_heap[i]; }
+
+    void
+    push(Flit *flt)
+    {
+        m_heap.push_back(flt);
+        std::push_heap(m_heap.begin(), m_heap.end(), greater);
+    }
+
+    Flit *
+    pop()
+    {
+        Flit *f = m_heap.front();
+        std::pop_heap(m_heap.begin(), m_heap.end(), greater);
+        m_heap.pop_back();
+        return f;
+    }
+
+  private:
+    std::vector<Flit *> m_heap;
+};
+
+/**
+ * flitBuffer over any flit type with get_time() and get_id(). flitBuffer
+ * is the garnet flit instance; the micro-benchmarks run the same code on
+ * a minimal flit.
+ */
+template <class Flit>
+class FlitBufferBase
+{
+  public:
+    FlitBufferBase() : max_size(INFINITE_) {}
+    FlitBufferBase(int maximum_size) : max_size(maximum_size) {}
+
+    // isReady/isEmpty/isFull are polled by every router and NI stage
+    // each cycle, so they are kept inline with the other heap operations.
+    bool
+    isReady(Cycles curTime)
+    {
+        return !m_buffer.empty() && m_buffer.top()->get_time() <= curTime;
+    }
+
+    bool isEmpty() { return m_buffer.empty(); }
+    void
+    print(std::ostream& out) const
+    {
+        out << "[flitBuffer: " << m_buffer.size() << "] " << std::endl;
+    }
+    bool isFull() { return m_buffer.size() >= max_size; }
+    void setMaxSize(int maximum) { max_size = maximum; }
+    int getSize() const { return m_buffer.size(); }
+
+    Flit *getTopFlit() { return m_buffer.pop(); }
+    Flit *peekTopFlit() { return m_buffer.top(); }
+    void insert(Flit *flt) { m_buffer.push(flt); }
+
+  protected:
+    FlitHeap<Flit> m_buffer;
+    int max_size;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_FLITBUFFERBASE_HH__
@@ -42,10 +42,14 @@ class NetworkLink(ClockedObject):
                               "virtual channels per virtual network")
     virt_nets = Param.Int(Parent.number_of_virtual_networks,
                           "number of virtual networks")
+    width = Param.UInt32(Parent.width, "link width in bits; 0 = flit width")
+    flit_size = Param.UInt32(Parent.ni_flit_size, "flit size in bytes")
 
 class CreditLink(NetworkLink):
     type = 'CreditLink'
     cxx_header = "mem/ruby/network/garnet2.0/CreditLink.hh"
+    # a credit always fits in a single phit
+    width = 0
 
 # Interior fixed pipeline links between routers
 class GarnetIntLink(BasicIntLink):
@@ -53,6 +57,8 @@ class GarnetIntLink(BasicIntLink):
     cxx_header = "mem/ruby/network/garnet2.0/GarnetLink.hh"
     # The internal link includes one forward link (for flit)
     # and one backward flow-control link (for credit)
+    width = Param.UInt32(0, "link width in bits; narrower links serialize "
+                            "each flit into phits, 0 = flit width")
     network_link = Param.NetworkLink(NetworkLink(), "forward link")
     credit_link  = Param.CreditLink(CreditLink(), "backward flow-control link")
 
@@ -64,6 +70,8 @@ class GarnetExtLink(BasicExtLink):
     # It includes two forward links (for flits)
     # and two backward flow-control links (for credits),
     # one per direction
+    width = Param.UInt32(0, "link width in bits; narrower links serialize "
+                            "each flit into phits, 0 = flit width")
     _nls = []
     # In uni-directional link
     _nls.append(NetworkLink());
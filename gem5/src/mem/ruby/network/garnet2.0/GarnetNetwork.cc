@@ -36,18 +36,27 @@
 #include <cassert>
 
 #include "base/cast.hh"
+#include "base/output.hh"
 #include "base/stl_helpers.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
+#include "mem/ruby/network/garnet2.0/ConvergenceMonitor.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
+#include "mem/ruby/network/garnet2.0/CrossbarSwitch.hh"
 #include "mem/ruby/network/garnet2.0/GarnetLink.hh"
 #include "mem/ruby/network/garnet2.0/NetworkInterface.hh"
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/NetworkTelemetry.hh"
+#include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 #include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
+#include "mem/ruby/network/garnet2.0/SpinRecovery.hh"
+#include "mem/ruby/network/garnet2.0/SwitchAllocator.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
 #include "mem/ruby/system/RubySystem.hh"
+#include "sim/core.hh"
+#include "sim/host_profiler.hh"
 
 using namespace std;
 using m5::stl_helpers::deletePointers;
@@ -88,8 +97,55 @@ GarnetNetwork::GarnetNetwork(const Params *p)
     tdm_ = p->tdm;
     m_swizzleSwap = p->swizzle_swap;
     m_policy = p->policy;
+    m_smart_hpc_max = p->smart_hpc_max;
+    m_multicast = p->multicast;
+    m_escape_vc = p->escape_vc;
+    m_bubble_flow_control = p->bubble_flow_control;
+    m_sa_arbitration = p->sa_arbitration;
+    m_sa_starvation_threshold = p->sa_starvation_threshold;
+    m_energy.buffer_read = p->energy_buffer_read;
+    m_energy.buffer_write = p->energy_buffer_write;
+    m_energy.sw_arbiter = p->energy_sw_arbiter;
+    m_energy.crossbar = p->energy_crossbar;
+    m_energy.link = p->energy_link;
+    m_energy.recovery_move = p->energy_recovery_move;
+    m_energy.buffer_leakage = p->leakage_buffer;
+    m_energy.port_leakage = p->leakage_port;
+    if (m_sa_arbitration >= NUM_SA_ARBITRATION_)
+        fatal("invalid sa_arbitration %d\n", m_sa_arbitration);
+    m_telemetry = NULL;
+    m_telemetry_interval = p->telemetry_interval;
+    m_telemetry_file = p->telemetry_file;
+    m_latency_pair_percentiles = p->latency_pair_percentiles;
+    m_convergence = NULL;
+    m_spin_recovery = NULL;
+    m_spin_timeout = p->spin_timeout;
+    m_ci_target = p->ci_target;
+    m_ci_batch_cycles = p->ci_batch_cycles;
+    m_ci_min_batches = p->ci_min_batches;
     prnt_cycle = 800;
 
+    if (m_escape_vc) {
+        // VC 0 of each vnet is the XY escape channel; the others are
+        // routed by routing_algorithm, which should be adaptive.
+        if (m_vcs_per_vnet < 2)
+            fatal("escape_vc needs at least 2 VCs per vnet\n");
+        if (m_num_rows <= 0)
+            fatal("escape_vc needs a 2D mesh (num_rows > 0)\n");
+        if (m_swizzleSwap)
+            fatal("escape_vc and swizzle_swap are exclusive\n");
+        if (m_routing_algorithm != ADAPT_RAND_)
+            warn("escape_vc: non-escape VCs use routing algorithm %d, "
+                 "not adaptive (%d)\n", m_routing_algorithm, ADAPT_RAND_);
+    }
+
+    // Bubble flow control: a ring entry must leave a packet-sized bubble
+    // behind, so a vnet has to buffer at least two 1-flit packets.
+    fatal_if(m_bubble_flow_control &&
+             m_vcs_per_vnet * m_buffers_per_ctrl_vc < 2,
+             "bubble_flow_control needs buffer slots for two packets per "
+             "vnet (vcs_per_vnet * buffers_per_ctrl_vc >= 2)\n");
+
     if (m_swizzleSwap) {
         // If interswap is set then 'whenToSwap' and 'whichToSwap' should
         // not be equal to 0. Assert.
@@ -104,6 +160,12 @@ GarnetNetwork::GarnetNetwork(const Params *p)
                 cout << " 'policy' :::: MINIMAL swizzleSwap Policy is used" << endl;
                 cout << "***********************************" << endl;
         #endif
+        } else if (m_policy == SPIN_) {
+        #if (MY_PRINT)
+                cout << "***********************************" << endl;
+                cout << " 'policy' :::: SPIN deadlock recovery is used" << endl;
+                cout << "***********************************" << endl;
+        #endif
         } else if (m_policy == NON_MINIMAL_) {
         #if (MY_PRINT)
                 cout << "***********************************" << endl;
@@ -121,6 +183,7 @@ GarnetNetwork::GarnetNetwork(const Params *p)
         fault_model = p->fault_model;
 
     m_vnet_type.resize(m_virtual_networks);
+    m_pkt_latency_dist.resize(m_virtual_networks);
 
     for (int i = 0 ; i < m_virtual_networks ; i++) {
         if (m_vnet_type_names[i] == "response")
@@ -175,6 +238,12 @@ GarnetNetwork::init()
         m_num_cols = -1;
     }
 
+    if (m_latency_pair_percentiles) {
+        // fewer sub-buckets per pair keeps this at a few KB per pair
+        m_pair_latency_dist.assign(m_routers.size() * m_routers.size(),
+                                   LogLinearHistogram(5));
+    }
+
     // FaultModel: declare each router to the fault model
     if (isFaultModelEnabled()) {
         for (vector<Router*>::const_iterator i= m_routers.begin();
@@ -191,10 +260,47 @@ GarnetNetwork::init()
             router->printFaultVector(cout);
         }
     }
+
+    // Let the host-time profiler report the network on its own
+    if (hostProfiling) {
+        const std::type_info *types[] = {
+            &typeid(Router), &typeid(NetworkInterface), &typeid(NetworkLink),
+            &typeid(CreditLink), &typeid(InputUnit), &typeid(OutputUnit),
+            &typeid(SwitchAllocator), &typeid(CrossbarSwitch)
+        };
+        for (auto type : types)
+            hostProfileGroup("network", *type, clockPeriod());
+    }
+}
+
+void
+GarnetNetwork::startup()
+{
+    Network::startup();
+
+    if (m_telemetry_interval > 0) {
+        m_telemetry = new NetworkTelemetry(this,
+            Cycles(m_telemetry_interval), m_telemetry_file);
+        m_telemetry->startup();
+    }
+
+    if (sim_type == 3) {
+        m_convergence = new ConvergenceMonitor(this, Cycles(warmup_cycles),
+            Cycles(m_ci_batch_cycles), m_ci_target, m_ci_min_batches);
+        m_convergence->startup();
+    }
+
+    if (m_swizzleSwap && m_policy == SPIN_) {
+        m_spin_recovery = new SpinRecovery(this, Cycles(m_spin_timeout));
+        m_spin_recovery->startup();
+    }
 }
 
 GarnetNetwork::~GarnetNetwork()
 {
+    delete m_telemetry;
+    delete m_convergence;
+    delete m_spin_recovery;
     deletePointers(m_routers);
     deletePointers(m_nis);
     deletePointers(m_networklinks);
@@ -285,6 +391,10 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
                                link->m_weight, credit_link);
+
+    if (m_router_neighbors.size() < m_routers.size())
+        m_router_neighbors.resize(m_routers.size());
+    m_router_neighbors[src][src_outport_dirn] = dest;
 }
 
 // Total routers in the network
@@ -301,9 +411,33 @@ GarnetNetwork::get_router_id(int ni)
     return m_nis[ni]->get_router_id();
 }
 
+NetDest
+GarnetNetwork::get_personal_dest(NodeID node)
+{
+    NetDest personal_dest;
+    for (int m = 0; m < (int) MachineType_NUM; m++) {
+        if ((node >= MachineType_base_number((MachineType) m)) &&
+            node < MachineType_base_number((MachineType) (m+1))) {
+            personal_dest.add((MachineID) {(MachineType) m, (node -
+                MachineType_base_number((MachineType) m))});
+            break;
+        }
+    }
+    return personal_dest;
+}
+
 Router*
 GarnetNetwork::get_RouterInDirn( PortDirection outport_dir, int my_id )
 {
+    // Use the neighbor recorded while building the topology if there
+    // is one; this also covers express links and non-square meshes.
+    if (my_id < (int)m_router_neighbors.size()) {
+        std::map<PortDirection, int>::const_iterator it =
+            m_router_neighbors[my_id].find(outport_dir);
+        if (it != m_router_neighbors[my_id].end())
+            return m_routers[it->second];
+    }
+
     int num_cols = getNumCols();
     int downstream_id = -1; // router_id for downstream router
 //    cout << "GarnetNetwork::get_RouterInDirn: outport_dir: " << outport_dir << endl;
@@ -716,6 +850,180 @@ GarnetNetwork::regStats()
     num_routed_bubbleSwaps
         .name(name() + ".routed_bubble_swaps");
 
+    num_smart_bypasses
+        .name(name() + ".smart_bypasses");
+    num_smart_routers_bypassed
+        .name(name() + ".smart_routers_bypassed");
+
+    // Multicast
+    num_multicast_forks
+        .name(name() + ".multicast_forks");
+
+    // Bubble flow control
+    num_bubble_fc_stalls
+        .name(name() + ".bubble_fc_stalls");
+
+    // Switch allocation: grants that differ from round robin
+    num_sa_priority_overrides
+        .name(name() + ".sa_priority_overrides");
+
+    // Energy (pJ) and power (mW)
+    m_dynamic_energy
+        .name(name() + ".dynamic_energy");
+    m_leakage_energy
+        .name(name() + ".leakage_energy");
+    m_link_energy
+        .name(name() + ".link_energy");
+    m_recovery_energy
+        .name(name() + ".recovery_energy");
+    m_total_energy
+        .name(name() + ".total_energy");
+    m_total_energy = m_dynamic_energy + m_leakage_energy + m_link_energy;
+    m_total_power
+        .name(name() + ".total_power");
+    m_energy_per_flit
+        .name(name() + ".energy_per_flit");
+    m_energy_per_flit = m_total_energy / sum(m_flits_received);
+    m_energy_delay_product
+        .name(name() + ".energy_delay_product");
+    m_energy_delay_product = m_total_energy * m_avg_packet_latency;
+
+    // Deadlock recovery
+    m_recovery_events
+        .name(name() + ".recovery_events");
+    m_recovery_flits_moved
+        .name(name() + ".recovery_flits_moved");
+    m_recovery_latency
+        .name(name() + ".recovery_latency");
+    m_avg_recovery_latency
+        .name(name() + ".average_recovery_latency");
+    m_avg_recovery_latency = m_recovery_latency / m_recovery_events;
+
+    num_spin_probes
+        .name(name() + ".spin_probes");
+    num_spin_deadlocks
+        .name(name() + ".spin_deadlocks");
+    num_spins
+        .name(name() + ".spins");
+    num_spin_aborts
+        .name(name() + ".spin_aborts");
+
+    m_multicast_pkt_injected
+        .init(m_virtual_networks)
+        .name(name() + ".multicast_packets_injected")
+        .flags(Stats::total | Stats::nozero | Stats::oneline)
+        ;
+    m_multicast_dests_injected
+        .init(m_virtual_networks)
+        .name(name() + ".multicast_destinations_injected")
+        .flags(Stats::total | Stats::nozero | Stats::oneline)
+        ;
+    m_multicast_pkt_received
+        .init(m_virtual_networks)
+        .name(name() + ".multicast_packets_received")
+        .flags(Stats::total | Stats::nozero | Stats::oneline)
+        ;
+    m_multicast_network_latency
+        .init(m_virtual_networks)
+        .name(name() + ".multicast_network_latency")
+        .flags(Stats::oneline)
+        ;
+    m_multicast_queueing_latency
+        .init(m_virtual_networks)
+        .name(name() + ".multicast_queueing_latency")
+        .flags(Stats::oneline)
+        ;
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_multicast_pkt_injected.subname(i, csprintf("vnet-%i", i));
+        m_multicast_dests_injected.subname(i, csprintf("vnet-%i", i));
+        m_multicast_pkt_received.subname(i, csprintf("vnet-%i", i));
+        m_multicast_network_latency.subname(i, csprintf("vnet-%i", i));
+        m_multicast_queueing_latency.subname(i, csprintf("vnet-%i", i));
+    }
+
+    m_multicast_latency_hist
+        .init(100)
+        .name(name() + ".multicast_latency_histogram")
+        .flags(Stats::pdf | Stats::total | Stats::nozero | Stats::oneline)
+        ;
+
+    m_avg_multicast_network_latency
+        .name(name() + ".average_multicast_network_latency");
+    m_avg_multicast_network_latency =
+        sum(m_multicast_network_latency) / sum(m_multicast_pkt_received);
+
+    m_avg_multicast_queueing_latency
+        .name(name() + ".average_multicast_queueing_latency");
+    m_avg_multicast_queueing_latency =
+        sum(m_multicast_queueing_latency) / sum(m_multicast_pkt_received);
+
+    m_avg_multicast_latency
+        .name(name() + ".average_multicast_latency");
+    m_avg_multicast_latency =
+        m_avg_multicast_network_latency + m_avg_multicast_queueing_latency;
+
+    // Escape VC
+    m_escape_vc_allocations
+        .init(m_virtual_networks)
+        .name(name() + ".escape_vc_allocations")
+        .flags(Stats::total | Stats::nozero | Stats::oneline)
+        ;
+    m_adaptive_vc_allocations
+        .init(m_virtual_networks)
+        .name(name() + ".adaptive_vc_allocations")
+        .flags(Stats::total | Stats::nozero | Stats::oneline)
+        ;
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_escape_vc_allocations.subname(i, csprintf("vnet-%i", i));
+        m_adaptive_vc_allocations.subname(i, csprintf("vnet-%i", i));
+    }
+
+    m_escape_vc_fraction
+        .name(name() + ".escape_vc_fraction");
+    m_escape_vc_fraction = sum(m_escape_vc_allocations) /
+        (sum(m_escape_vc_allocations) + sum(m_adaptive_vc_allocations));
+
+    m_packet_latency_p50
+        .init(m_virtual_networks)
+        .name(name() + ".packet_latency_p50")
+        .flags(Stats::oneline)
+        ;
+    m_packet_latency_p99
+        .init(m_virtual_networks)
+        .name(name() + ".packet_latency_p99")
+        .flags(Stats::oneline)
+        ;
+    m_packet_latency_p999
+        .init(m_virtual_networks)
+        .name(name() + ".packet_latency_p99_9")
+        .flags(Stats::oneline)
+        ;
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_packet_latency_p50.subname(i, csprintf("vnet-%i", i));
+        m_packet_latency_p99.subname(i, csprintf("vnet-%i", i));
+        m_packet_latency_p999.subname(i, csprintf("vnet-%i", i));
+    }
+
+    m_marked_packet_latency_p50
+        .name(name() + ".marked_packet_latency_p50");
+    m_marked_packet_latency_p99
+        .name(name() + ".marked_packet_latency_p99");
+    m_marked_packet_latency_p999
+        .name(name() + ".marked_packet_latency_p99_9");
+
+    m_ci_converged
+        .name(name() + ".ci_converged");
+    m_ci_batches
+        .name(name() + ".ci_batches");
+    m_ci_latency_mean
+        .name(name() + ".ci_latency_mean");
+    m_ci_latency_half_width
+        .name(name() + ".ci_latency_half_width");
+    m_ci_throughput_mean
+        .name(name() + ".ci_throughput_mean");
+    m_ci_throughput_half_width
+        .name(name() + ".ci_throughput_half_width");
+
     m_average_vc_load
         .init(m_virtual_networks * m_vcs_per_vnet)
         .name(name() + ".avg_vc_load")
@@ -753,6 +1061,116 @@ GarnetNetwork::collateStats()
     for (int i = 0; i < m_routers.size(); i++) {
         m_routers[i]->collateStats();
     }
+
+    // Energy: routers (buffers, allocators, crossbar, recovery moves,
+    // leakage) plus one link traversal per flit on every link. A SMART
+    // bypass is only seen by the link out of its last router; the links
+    // into the bypassed routers are charged here.
+    double time_ns = time_delta * clockPeriod() / SimClock::Int::ns;
+    double dynamic_energy = 0.0;
+    double leakage_energy = 0.0;
+    double recovery_energy = 0.0;
+    for (int i = 0; i < m_routers.size(); i++) {
+        m_routers[i]->collateEnergy(time_ns);
+        dynamic_energy += m_routers[i]->get_dynamic_energy();
+        leakage_energy += m_routers[i]->get_leakage_energy();
+        recovery_energy += m_routers[i]->get_recovery_energy();
+    }
+    double link_energy = 0.0;
+    for (int i = 0; i < m_networklinks.size(); i++) {
+        link_energy +=
+            m_networklinks[i]->getLinkUtilization() * m_energy.link;
+    }
+    link_energy += num_smart_routers_bypassed.value() * m_energy.link;
+    m_dynamic_energy = dynamic_energy;
+    m_leakage_energy = leakage_energy;
+    m_link_energy = link_energy;
+    m_recovery_energy = recovery_energy;
+    if (time_ns > 0.0) {
+        m_total_power =
+            (dynamic_energy + leakage_energy + link_energy) / time_ns;
+    }
+
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_packet_latency_p50[i] = m_pkt_latency_dist[i].percentile(50.0);
+        m_packet_latency_p99[i] = m_pkt_latency_dist[i].percentile(99.0);
+        m_packet_latency_p999[i] = m_pkt_latency_dist[i].percentile(99.9);
+    }
+    m_marked_packet_latency_p50 = m_marked_pkt_latency_dist.percentile(50.0);
+    m_marked_packet_latency_p99 = m_marked_pkt_latency_dist.percentile(99.0);
+    m_marked_packet_latency_p999 =
+        m_marked_pkt_latency_dist.percentile(99.9);
+
+    if (m_latency_pair_percentiles)
+        dumpPairLatencyPercentiles();
+
+    if (m_convergence) {
+        m_ci_converged = m_convergence->is_converged();
+        m_ci_batches = m_convergence->get_num_batches();
+        m_ci_latency_mean = m_convergence->get_latency_mean();
+        m_ci_latency_half_width = m_convergence->get_latency_half_width();
+        m_ci_throughput_mean = m_convergence->get_throughput_mean();
+        m_ci_throughput_half_width =
+            m_convergence->get_throughput_half_width();
+    }
+}
+
+void
+GarnetNetwork::resetStats()
+{
+    for (int i = 0; i < m_pkt_latency_dist.size(); i++)
+        m_pkt_latency_dist[i].clear();
+    m_marked_pkt_latency_dist.clear();
+    for (int i = 0; i < m_pair_latency_dist.size(); i++)
+        m_pair_latency_dist[i].clear();
+}
+
+void
+GarnetNetwork::update_packet_latency_percentiles(Cycles latency, int vnet,
+                                                 bool marked, int src_router,
+                                                 int dest_router)
+{
+    m_pkt_latency_dist[vnet].add(latency);
+    if (marked)
+        m_marked_pkt_latency_dist.add(latency);
+
+    if (m_latency_pair_percentiles) {
+        int num_routers = m_routers.size();
+        m_pair_latency_dist[src_router * num_routers + dest_router]
+            .add(latency);
+    }
+}
+
+void
+GarnetNetwork::record_convergence_sample(Cycles latency)
+{
+    if (m_convergence)
+        m_convergence->record_packet(latency);
+}
+
+// One block of rows per stats dump; pairs that saw no packets are skipped.
+void
+GarnetNetwork::dumpPairLatencyPercentiles()
+{
+    OutputStream *os = simout.findOrCreate("latency_pairs.csv");
+    ostream &out = *os->stream();
+    int num_routers = m_routers.size();
+
+    out << "cycle,src_router,dest_router,packets,p50,p99,p99_9,max"
+        << endl;
+    for (int src = 0; src < num_routers; src++) {
+        for (int dest = 0; dest < num_routers; dest++) {
+            const LogLinearHistogram &dist =
+                m_pair_latency_dist[src * num_routers + dest];
+            if (dist.size() == 0)
+                continue;
+            out << curCycle() << "," << src << "," << dest << ","
+                << dist.size() << "," << dist.percentile(50.0) << ","
+                << dist.percentile(99.0) << "," << dist.percentile(99.9)
+                << "," << dist.getMax() << endl;
+        }
+    }
+    out.flush();
 }
 
 bool
@@ -35,8 +35,10 @@
 #define __MEM_RUBY_NETWORK_GARNET2_0_GARNETNETWORK_HH__
 
 #include <iostream>
+#include <map>
 #include <vector>
 
+#include "mem/ruby/common/LogLinearHistogram.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/network/fault_model/FaultModel.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
@@ -48,9 +50,26 @@ class NetworkInterface;
 class Router;
 class NetDest;
 class NetworkLink;
+class NetworkTelemetry;
 class CreditLink;
+class ConvergenceMonitor;
+class SpinRecovery;
 
 using namespace std;
+// Activity-based energy model: dynamic energy per event in pJ,
+// leakage power in mW (= pJ/ns)
+struct NocEnergyModel
+{
+    double buffer_read;   // per flit read from an input VC
+    double buffer_write;  // per flit written into an input VC
+    double sw_arbiter;    // per SA-I or SA-II arbitration
+    double crossbar;      // per flit crossing the crossbar
+    double link;          // per flit crossing a link
+    double recovery_move; // per flit moved by a swap, deflection or spin
+    double buffer_leakage; // per flit buffer
+    double port_leakage;   // per router input or output port
+};
+
 class GarnetNetwork : public Network
 {
   public:
@@ -59,6 +78,7 @@ class GarnetNetwork : public Network
 
     ~GarnetNetwork();
     void init();
+    void startup();
 
     // Configuration (set externally)
 
@@ -77,6 +97,25 @@ class GarnetNetwork : public Network
 	// interSwap congfig.
 	bool isEnableSwizzleSwap() const { return m_swizzleSwap; }
 	uint32_t getPolicy() const {return m_policy; }
+    // SPIN_ policy: synchronized-spin recovery engine (NULL otherwise)
+    SpinRecovery* get_spin_recovery() { return m_spin_recovery; }
+    // SMART multi-hop bypass config.
+    uint32_t getSmartHpcMax() const { return m_smart_hpc_max; }
+    bool isSmartEnabled() const { return m_smart_hpc_max > 1; }
+    // in-network multicast config.
+    bool isMulticastEnabled() const { return m_multicast; }
+    // escape-VC (Duato) deadlock avoidance config.
+    bool isEscapeVcEnabled() const { return m_escape_vc; }
+    // bubble flow control (rings of a torus) config.
+    bool isBubbleFlowControl() const { return m_bubble_flow_control; }
+    // switch allocation arbitration policy (SaArbitration)
+    uint32_t getSaArbitration() const { return m_sa_arbitration; }
+    const NocEnergyModel& getEnergyModel() const { return m_energy; }
+    uint32_t
+    getSaStarvationThreshold() const
+    {
+        return m_sa_starvation_threshold;
+    }
     void scanNetwork(void);
 
 
@@ -93,8 +132,12 @@ class GarnetNetwork : public Network
         return m_vnet_type[vnet];
     }
     int getNumRouters();
-    std::vector<Router *> get_routers_ref() { return(m_routers); }
+    std::vector<Router *>& get_routers_ref() { return(m_routers); }
+    std::vector<NetworkLink *>&
+    get_networklinks_ref() { return m_networklinks; }
     int get_router_id(int ni);
+    // NetDest holding only the given destination node
+    NetDest get_personal_dest(NodeID node);
 
 
     // Methods used by Topology to setup the network
@@ -114,6 +157,7 @@ class GarnetNetwork : public Network
     // Stats
     void collateStats();
     void regStats();
+    void resetStats();
     void print(std::ostream& out) const;
 
     bool check_mrkd_flt(void);
@@ -256,6 +300,46 @@ class GarnetNetwork : public Network
         }
     }
 
+    void increment_multicast_injected(int vnet, int num_dests) {
+        m_multicast_pkt_injected[vnet]++;
+        m_multicast_dests_injected[vnet] += num_dests;
+    }
+
+    // escape-VC mode: class of the VC a head flit was granted
+    void increment_vc_class_allocations(int vnet, bool escape) {
+        if (escape)
+            m_escape_vc_allocations[vnet]++;
+        else
+            m_adaptive_vc_allocations[vnet]++;
+    }
+
+    void increment_multicast_received(int vnet, Cycles network_delay,
+                                      Cycles queueing_delay) {
+        m_multicast_pkt_received[vnet]++;
+        m_multicast_network_latency[vnet] += network_delay;
+        m_multicast_queueing_latency[vnet] += queueing_delay;
+        m_multicast_latency_hist.sample(network_delay + queueing_delay);
+    }
+
+    // record the total latency of a delivered packet for the
+    // p50/p99/p99.9 stats
+    void update_packet_latency_percentiles(Cycles latency, int vnet,
+                                           bool marked, int src_router,
+                                           int dest_router);
+
+    // deadlock recovery (swizzle-swap or spin) moved flits that had
+    // been blocked for up to 'latency' cycles
+    void
+    record_recovery(int flits_moved, Cycles latency)
+    {
+        m_recovery_events++;
+        m_recovery_flits_moved += flits_moved;
+        m_recovery_latency += latency;
+    }
+
+    // sim_type 3: feed a delivered packet to the stopping rule
+    void record_convergence_sample(Cycles latency);
+
     void
     increment_total_hops(int hops, bool marked)
     {
@@ -318,6 +402,15 @@ class GarnetNetwork : public Network
     Stats::Scalar num_bubbleSwizzles;
     Stats::Scalar num_bubbleSwaps;
     Stats::Scalar num_routed_bubbleSwaps;
+    Stats::Scalar num_smart_bypasses;
+    Stats::Scalar num_smart_routers_bypassed;
+    Stats::Scalar num_multicast_forks;
+    Stats::Scalar num_bubble_fc_stalls;
+    Stats::Scalar num_sa_priority_overrides;
+    Stats::Scalar num_spin_probes;
+    Stats::Scalar num_spin_deadlocks;
+    Stats::Scalar num_spins;
+    Stats::Scalar num_spin_aborts;
 
   protected:
     Stats::Vector m_marked_flt_dist;
@@ -335,6 +428,23 @@ class GarnetNetwork : public Network
 
     bool m_swizzleSwap;
     uint32_t m_policy;
+    uint32_t m_smart_hpc_max;
+    bool m_multicast;
+    bool m_escape_vc;
+    bool m_bubble_flow_control;
+    uint32_t m_sa_arbitration;
+    NocEnergyModel m_energy;
+    uint32_t m_sa_starvation_threshold;
+    NetworkTelemetry *m_telemetry;
+    uint32_t m_telemetry_interval;
+    std::string m_telemetry_file;
+    bool m_latency_pair_percentiles;
+    ConvergenceMonitor *m_convergence;
+    SpinRecovery *m_spin_recovery;
+    uint32_t m_spin_timeout;
+    double m_ci_target;
+    uint32_t m_ci_batch_cycles;
+    uint32_t m_ci_min_batches;
 
     // Statistical variables
     Stats::Vector m_packets_received;
@@ -402,15 +512,75 @@ class GarnetNetwork : public Network
     Stats::Scalar m_average_link_utilization;
     Stats::Vector m_average_vc_load;
 
+    // in-network multicast: one packet injected, one delivery per dest
+    Stats::Vector m_multicast_pkt_injected;
+    Stats::Vector m_multicast_dests_injected;
+    Stats::Vector m_multicast_pkt_received;
+    Stats::Vector m_multicast_network_latency;
+    Stats::Vector m_multicast_queueing_latency;
+    Stats::Histogram m_multicast_latency_hist;
+    Stats::Formula m_avg_multicast_network_latency;
+    Stats::Formula m_avg_multicast_queueing_latency;
+    Stats::Formula m_avg_multicast_latency;
+
+    // escape-VC mode: VC allocations per class, one per packet per hop
+    Stats::Vector m_escape_vc_allocations;
+    Stats::Vector m_adaptive_vc_allocations;
+    Stats::Formula m_escape_vc_fraction;
+
+    // energy and power, from the activity counts and NocEnergyModel
+    Stats::Scalar m_dynamic_energy;
+    Stats::Scalar m_leakage_energy;
+    Stats::Scalar m_link_energy;
+    Stats::Scalar m_recovery_energy;
+    Stats::Formula m_total_energy;
+    Stats::Scalar m_total_power;
+    Stats::Formula m_energy_per_flit;
+    Stats::Formula m_energy_delay_product;
+
+    // deadlock recovery, shared by the swizzle-swap and spin engines
+    Stats::Scalar m_recovery_events;
+    Stats::Scalar m_recovery_flits_moved;
+    Stats::Scalar m_recovery_latency;
+    Stats::Formula m_avg_recovery_latency;
+
     Stats::Scalar  m_total_hops;
     Stats::Formula m_avg_hops;
 
+    // Tail latency: log-linear histograms of total packet latency,
+    // reduced to percentiles in collateStats()
+    std::vector<LogLinearHistogram> m_pkt_latency_dist;
+    LogLinearHistogram m_marked_pkt_latency_dist;
+    // [src_router * num_routers + dest_router], empty unless
+    // latency_pair_percentiles is set
+    std::vector<LogLinearHistogram> m_pair_latency_dist;
+
+    Stats::Vector m_packet_latency_p50;
+    Stats::Vector m_packet_latency_p99;
+    Stats::Vector m_packet_latency_p999;
+    Stats::Scalar m_marked_packet_latency_p50;
+    Stats::Scalar m_marked_packet_latency_p99;
+    Stats::Scalar m_marked_packet_latency_p999;
+
+    // sim_type 3: batch-means stopping rule
+    Stats::Scalar m_ci_converged;
+    Stats::Scalar m_ci_batches;
+    Stats::Scalar m_ci_latency_mean;
+    Stats::Scalar m_ci_latency_half_width;
+    Stats::Scalar m_ci_throughput_mean;
+    Stats::Scalar m_ci_throughput_half_width;
+
   private:
+    void dumpPairLatencyPercentiles();
+
     GarnetNetwork(const GarnetNetwork& obj);
     GarnetNetwork& operator=(const GarnetNetwork& obj);
 
     std::vector<VNET_type > m_vnet_type;
     std::vector<Router *> m_routers;   // All Routers in Network
+    // Downstream router id of each internal outport direction,
+    // as built by the topology: [router][outport direction]
+    std::vector<std::map<PortDirection, int> > m_router_neighbors;
     std::vector<NetworkLink *> m_networklinks; // All flit links in the network
     std::vector<CreditLink *> m_creditlinks; // All credit links in the network
     std::vector<NetworkInterface *> m_nis;   // All NI's in Network
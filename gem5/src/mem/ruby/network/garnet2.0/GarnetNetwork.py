@@ -43,12 +43,58 @@ class GarnetNetwork(RubyNetwork):
 
     swizzle_swap = Param.UInt32(0, "To enable swizzleSwap")
     policy = Param.UInt32(0, "Policy to be used applicable when swizzleSwap is 1")
+    spin_timeout = Param.UInt32(128, "policy 3 (spin): cycles a flit waits "
+                                     "in SA before probing for a deadlock")
     tdm = Param.UInt32(0, "when to swizzle; applicable when swizzleSwap is 1")
+    multicast = Param.Bool(False, "inject a single-flit multicast as one "
+                           "packet and fork it inside the routers")
+    escape_vc = Param.Bool(False, "reserve VC 0 of each vnet as an XY "
+                           "escape channel (Duato); the other VCs use "
+                           "routing_algorithm, e.g. 3 (adaptive)")
+    bubble_flow_control = Param.Bool(False, "a packet entering a "
+                                     "dimension ring (injection or turn) "
+                                     "needs free buffer slots for two "
+                                     "packets downstream")
+    sa_arbitration = Param.UInt32(0, "switch allocation arbitration: "
+                                     "0 round robin, 1 oldest first, "
+                                     "2 most hops first, 3 starvation "
+                                     "aware")
+    sa_starvation_threshold = Param.UInt32(16, "sa_arbitration 3: cycles "
+                                               "an input VC waits before "
+                                               "its priority escalates")
+    # activity-based energy model; the defaults are placeholders, take
+    # the values for your technology and flit width from DSENT or ORION
+    energy_buffer_read = Param.Float(0.8, "pJ per flit read from a VC")
+    energy_buffer_write = Param.Float(1.0, "pJ per flit written to a VC")
+    energy_sw_arbiter = Param.Float(0.1, "pJ per switch arbitration")
+    energy_crossbar = Param.Float(1.5, "pJ per crossbar traversal")
+    energy_link = Param.Float(2.0, "pJ per flit per link traversal")
+    energy_recovery_move = Param.Float(3.8, "pJ per flit moved by a "
+                                       "bubble swap, deflection or spin")
+    leakage_buffer = Param.Float(0.01, "leakage mW per flit buffer")
+    leakage_port = Param.Float(0.1, "leakage mW per router port")
+    telemetry_interval = Param.UInt32(0, "sample per-router and per-link "
+                                         "telemetry every N cycles; "
+                                         "0 disables")
+    telemetry_file = Param.String("garnet_telemetry", "prefix of the "
+                                  "telemetry CSV files in the output dir")
+    latency_pair_percentiles = Param.Bool(False, "also track packet "
+                                          "latency percentiles per "
+                                          "source/destination router pair")
+    ci_target = Param.Float(0.05, "sim_type 3: stop once the 95% CI "
+                            "half-width of latency and throughput is "
+                            "within this fraction of the mean")
+    ci_batch_cycles = Param.UInt32(1000, "sim_type 3: initial batch "
+                                         "length in cycles")
+    ci_min_batches = Param.UInt32(10, "sim_type 3: batches needed before "
+                                      "the run may stop (2 to 32)")
+    smart_hpc_max = Param.UInt32(1, "max hops a flit can bypass per cycle "
+                                    "(SMART); 1 disables multi-hop bypass")
 
     buffers_per_data_vc = Param.UInt32(4, "buffers per data virtual channel");
     buffers_per_ctrl_vc = Param.UInt32(1, "buffers per ctrl virtual channel");
     routing_algorithm = Param.Int(0,
-        "0: Weight-based Table, 1: XY, 2: Custom");
+        "0: Weight-based Table, 1: XY, 2: Custom, 8: Express XY");
     enable_fault_model = Param.Bool(False, "enable network fault model");
     fault_model = Param.FaultModel(NULL, "network fault model");
     garnet_deadlock_threshold = Param.UInt32(50000,
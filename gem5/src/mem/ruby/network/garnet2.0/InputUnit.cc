@@ -98,18 +98,31 @@ InputUnit::wakeup()
             set_vc_active(vc, m_router->curCycle());
 
             // Route computation for this vc
-            int outport = m_router->route_compute(t_flit->get_route(),
-                m_id, m_direction);
+            // (multicast flits may also fork into several branches here)
+            int outport;
+            if (t_flit->is_multicast()) {
+                outport = m_router->route_compute_multicast(t_flit,
+                    m_id, m_direction);
+            } else {
+                outport = m_router->route_compute(t_flit->get_route(),
+                    m_id, m_direction);
+            }
 
             // set the outport in the flit as well as the direction of the
             // outport in the flit.
             t_flit->set_outport(outport);
             PortDirection out_dirn = m_router->getOutportDirection(outport);
             t_flit->set_outport_dir(out_dirn);
-            // Update output port in VC
-            // All flits in this packet will use this output port
-            // The output port field in the flit is updated after it wins SA
-            // grant_outport(vc, outport);
+            // Escape-VC mode: the head may fall back to the escape VC at
+            // the XY outport if no adaptive VC is free at this outport.
+            // Multicast trees have no escape path.
+            if (m_router->get_net_ptr()->isEscapeVcEnabled() &&
+                !t_flit->is_multicast()) {
+                t_flit->set_escape_outport(m_router->escape_route_compute(
+                    t_flit->get_route(), m_id, m_direction));
+            }
+            // The output port in the VC is set when the head wins SA-II;
+            // the rest of the packet follows it there.
 
         } else {
             assert(m_vcs[vc]->get_state() == ACTIVE_);
@@ -150,6 +150,27 @@ class InputUnit : public Consumer
     int get_id() { return m_id; }
     bool vc_isEmpty(int vcId) { return m_vcs[vcId]->isEmpty(); }
 
+    inline int
+    get_num_occupied_vcs()
+    {
+        int occupied = 0;
+        for (int vc = 0; vc < m_num_vcs; vc++) {
+            if (!m_vcs[vc]->isEmpty())
+                occupied++;
+        }
+        return occupied;
+    }
+
+    inline bool
+    isEmpty()
+    {
+        for (int vc = 0; vc < m_num_vcs; vc++) {
+            if (!m_vcs[vc]->isEmpty())
+                return false;
+        }
+        return true;
+    }
+
 
     inline void
     insertFlit(int vc_id, flit *t_flit) {
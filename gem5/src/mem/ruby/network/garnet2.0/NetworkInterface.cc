@@ -33,6 +33,7 @@
 
 #include "mem/ruby/network/garnet2.0/NetworkInterface.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -170,13 +171,21 @@ NetworkInterface::incrementStats(flit *t_flit)
                                                         t_flit->m_marked);
             m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet,
                                                         t_flit->m_marked);
+            m_net_ptr->update_packet_latency_percentiles(total_delay, vnet,
+                t_flit->m_marked, t_flit->get_route().src_router,
+                m_router_id);
         }
 
         // Hops
         m_net_ptr->increment_total_hops(t_flit->get_route().hops_traversed, t_flit->m_marked);
 
+        if (t_flit->is_multicast()) {
+            m_net_ptr->increment_multicast_received(vnet, network_delay,
+                                                    queueing_delay);
+        }
+
     }else {
-        assert(m_net_ptr->sim_type == 1);
+        assert(m_net_ptr->sim_type == 1 || m_net_ptr->sim_type == 3);
         // Latency
         m_net_ptr->increment_received_flits(vnet, t_flit->m_marked);
         Cycles network_delay =
@@ -198,10 +207,19 @@ NetworkInterface::incrementStats(flit *t_flit)
                                                         t_flit->m_marked);
             m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet,
                                                         t_flit->m_marked);
+            m_net_ptr->update_packet_latency_percentiles(total_delay, vnet,
+                t_flit->m_marked, t_flit->get_route().src_router,
+                m_router_id);
+            m_net_ptr->record_convergence_sample(total_delay);
         }
 
         // Hops
         m_net_ptr->increment_total_hops(t_flit->get_route().hops_traversed, t_flit->m_marked);
+
+        if (t_flit->is_multicast()) {
+            m_net_ptr->increment_multicast_received(vnet, network_delay,
+                                                    queueing_delay);
+        }
     }
 }
 
@@ -261,7 +279,7 @@ NetworkInterface::wakeup()
             if (!messageEnqueuedThisCycle &&
                 outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
                 // Space is available. Enqueue to protocol buffer.
-                outNode_ptr[vnet]->enqueue(t_flit->get_msg_ptr(), curTime,
+                outNode_ptr[vnet]->enqueue(ejectMsgPtr(t_flit), curTime,
                                            cyclesToTicks(Cycles(1)));
 
                 // Simply send a credit back since we are not buffering
@@ -319,6 +337,20 @@ NetworkInterface::sendCredit(flit *t_flit, bool is_free)
     outCreditQueue->insert(credit_flit);
 }
 
+// The message to hand to the protocol for an ejected flit. A multicast
+// packet shares one message among all its destinations, so each
+// destination gets its own copy addressed only to itself.
+MsgPtr
+NetworkInterface::ejectMsgPtr(flit *t_flit)
+{
+    if (!t_flit->is_multicast())
+        return t_flit->get_msg_ptr();
+
+    MsgPtr msg_ptr = t_flit->get_msg_ptr()->clone();
+    msg_ptr->getDestination() = t_flit->get_route().net_dest;
+    return msg_ptr;
+}
+
 bool
 NetworkInterface::checkStallQueue()
 {
@@ -333,7 +365,7 @@ NetworkInterface::checkStallQueue()
 
             // If we can now eject to the protocol buffer, send back credits
             if (outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
-                outNode_ptr[vnet]->enqueue(stallFlit->get_msg_ptr(), curTime,
+                outNode_ptr[vnet]->enqueue(ejectMsgPtr(stallFlit), curTime,
                                            cyclesToTicks(Cycles(1)));
 
                 // Send back a credit with free signal now that the VC is no
@@ -379,6 +411,63 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
     int num_flits = (int) ceil((double) m_net_ptr->MessageSizeType_to_int(
         net_msg_ptr->getMessageSize())/m_net_ptr->getNiFlitSize());
 
+    // In-network multicast: inject a single packet carrying all the
+    // destinations and let the routers fork it. Only single-flit packets
+    // in unordered vnets are sent this way; the bubble (swizzleSwap)
+    // scheme moves single flits between routers and is not multicast
+    // aware, so it keeps using unicast copies.
+    if (m_net_ptr->isMulticastEnabled() && dest_nodes.size() > 1 &&
+        num_flits == 1 && !m_net_ptr->isVNetOrdered(vnet) &&
+        !m_net_ptr->isEnableSwizzleSwap()) {
+
+        int vc = calculateVC(vnet);
+        if (vc == -1) {
+            return false;
+        }
+
+        RouteInfo route;
+        route.vnet = vnet;
+        route.net_dest = net_msg_dest;
+        route.src_ni = m_id;
+        route.src_router = m_router_id;
+        // computed per destination in the routers
+        route.dest_ni = -1;
+        route.dest_router = -1;
+        route.hops_traversed = -1;
+
+        // sim_type 2: the copy delivered to every destination is a
+        // marked flit (forks keep the mark), so a marked multicast uses
+        // up one marked flit per destination.
+        bool marked = false;
+        Router *router = m_net_ptr->get_routers_ref().at(m_router_id);
+        if (m_net_ptr->sim_type == 2 &&
+            curCycle() > (Cycles)m_net_ptr->warmup_cycles &&
+            router->mrkd_flt_ > 0) {
+            marked = true;
+            router->mrkd_flt_ -= std::min((int)dest_nodes.size(),
+                                          router->mrkd_flt_);
+        }
+
+        flit *fl = new flit(0, vc, vnet, route, num_flits, msg_ptr,
+                            curCycle(), marked);
+        fl->set_multicast(true);
+        // Every destination receives its own copy and counts it in
+        // flits/packets_received, so count one injection per destination
+        // as the unicast path does.
+        for (int ctr = 0; ctr < dest_nodes.size(); ctr++) {
+            m_net_ptr->increment_injected_flits(vnet, fl->m_marked,
+                                                m_router_id);
+            m_net_ptr->increment_injected_packets(vnet, fl->m_marked);
+        }
+        m_net_ptr->increment_multicast_injected(vnet, dest_nodes.size());
+        fl->set_src_delay(curCycle() - ticksToCycles(msg_ptr->getTime()));
+        m_ni_out_vcs[vc]->insert(fl);
+
+        m_ni_out_vcs_enqueue_time[vc] = curCycle();
+        m_out_vc_state[vc]->setState(ACTIVE_, curCycle());
+        return true;
+    }
+
     // loop to convert all multicast messages into unicast messages
     for (int ctr = 0; ctr < dest_nodes.size(); ctr++) {
 
@@ -393,18 +482,9 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
 
         Message *new_net_msg_ptr = new_msg_ptr.get();
         if (dest_nodes.size() > 1) {
-            NetDest personal_dest;
-            for (int m = 0; m < (int) MachineType_NUM; m++) {
-                if ((destID >= MachineType_base_number((MachineType) m)) &&
-                    destID < MachineType_base_number((MachineType) (m+1))) {
-                    // calculating the NetDest associated with this destID
-                    personal_dest.clear();
-                    personal_dest.add((MachineID) {(MachineType) m, (destID -
-                        MachineType_base_number((MachineType) m))});
-                    new_net_msg_ptr->getDestination() = personal_dest;
-                    break;
-                }
-            }
+            // calculating the NetDest associated with this destID
+            NetDest personal_dest = m_net_ptr->get_personal_dest(destID);
+            new_net_msg_ptr->getDestination() = personal_dest;
             net_msg_dest.removeNetDest(personal_dest);
             // removing the destination from the original message to reflect
             // that a message with this particular destination has been
@@ -110,6 +110,7 @@ class NetworkInterface : public ClockedObject, public Consumer
 
     bool checkStallQueue();
     bool flitisizeMessage(MsgPtr msg_ptr, int vnet);
+    MsgPtr ejectMsgPtr(flit *t_flit);
     int calculateVC(int vnet);
 
     void scheduleOutputLink();
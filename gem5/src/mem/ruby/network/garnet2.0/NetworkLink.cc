@@ -33,6 +33,7 @@
 
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
 
+#include "base/logging.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
 
 NetworkLink::NetworkLink(const Params *p)
@@ -43,6 +44,16 @@ NetworkLink::NetworkLink(const Params *p)
       link_srcQueue(nullptr), m_link_utilized(0),
       m_vc_load(p->vcs_per_vnet * p->virt_nets)
 {
+    // SerDes at a width boundary: ceil(flit bits / link bits) phits
+    int flit_bits = p->flit_size * 8;
+    m_phits = Cycles(1);
+    m_busy_until = Cycles(0);
+    if (p->width > 0 && p->width < flit_bits) {
+        m_phits = Cycles((flit_bits + p->width - 1) / p->width);
+    } else if (p->width > flit_bits) {
+        warn("link %d is %d bits wide but flits are %d bits; a link moves "
+             "at most one flit per cycle\n", m_id, p->width, flit_bits);
+    }
 }
 
 NetworkLink::~NetworkLink()
@@ -62,16 +73,35 @@ NetworkLink::setSourceQueue(flitBuffer *srcQueue)
     link_srcQueue = srcQueue;
 }
 
+/*
+ * A flit is sent on to the link if the link is not busy serializing an
+ * earlier flit. On a link narrower than a flit, the serializer holds the
+ * link for m_phits cycles and the deserializer at the far end delivers
+ * the reassembled flit (m_phits - 1) cycles after the plain link latency.
+ * Flits waiting for the link stay in the source queue; their credits
+ * were already consumed at SA, so credit accounting is unaffected.
+ */
 void
 NetworkLink::wakeup()
 {
+    if (curCycle() < m_busy_until) {
+        if (link_srcQueue->isReady(curCycle()))
+            scheduleEventAbsolute(clockEdge(m_busy_until - curCycle()));
+        return;
+    }
+
     if (link_srcQueue->isReady(curCycle())) {
         flit *t_flit = link_srcQueue->getTopFlit();
-        t_flit->set_time(curCycle() + m_latency);
+        Cycles delay = m_latency + m_phits - Cycles(1);
+        t_flit->set_time(curCycle() + delay);
         linkBuffer->insert(t_flit);
-        link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+        link_consumer->scheduleEventAbsolute(clockEdge(delay));
         m_link_utilized++;
         m_vc_load[t_flit->get_vc()]++;
+
+        m_busy_until = curCycle() + m_phits;
+        if (m_phits > Cycles(1) && link_srcQueue->getSize() > 0)
+            scheduleEventAbsolute(clockEdge(m_phits));
     }
 }
 
@@ -60,6 +60,9 @@ class NetworkLink : public ClockedObject, public Consumer
     int get_id() const { return m_id; }
     void wakeup();
 
+    // number of cycles a flit occupies this link
+    Cycles getSerializationCycles() const { return m_phits; }
+
     unsigned int getLinkUtilization() const { return m_link_utilized; }
     const std::vector<unsigned int> & getVcLoad() const { return m_vc_load; }
     // swizzleSwap structure...
@@ -80,6 +83,10 @@ class NetworkLink : public ClockedObject, public Consumer
     const int m_id;
     link_type m_type;
     const Cycles m_latency;
+    // A link narrower than a flit serializes every flit into m_phits
+    // phits; the link is busy until m_busy_until.
+    Cycles m_phits;
+    Cycles m_busy_until;
 
     flitBuffer *linkBuffer;
     Consumer *link_consumer;
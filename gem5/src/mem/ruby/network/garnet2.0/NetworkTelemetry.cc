@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet2.0/NetworkTelemetry.hh"
+
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet2.0/InputUnit.hh"
+#include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/Router.hh"
+
+using namespace std;
+
+NetworkTelemetry::NetworkTelemetry(GarnetNetwork *net_ptr, Cycles interval,
+                                   const std::string &prefix)
+    : m_net_ptr(net_ptr), m_interval(interval),
+      m_sample_event([this]{ sample(); }, "Garnet telemetry sample"),
+      m_router_file(NULL), m_link_file(NULL)
+{
+    assert(m_interval > Cycles(0));
+
+    m_router_file = simout.create(prefix + ".routers.csv");
+    m_link_file = simout.create(prefix + ".links.csv");
+
+    *m_router_file->stream() << "cycle,router,occupied_vcs,"
+                             << "critical_inport,critical_dirn,"
+                             << "swizzles,bubble_moves,deflections\n";
+    *m_link_file->stream() << "cycle,link,type,flits\n";
+}
+
+NetworkTelemetry::~NetworkTelemetry()
+{
+    if (m_sample_event.scheduled())
+        m_net_ptr->deschedule(m_sample_event);
+    simout.close(m_router_file);
+    simout.close(m_link_file);
+}
+
+void
+NetworkTelemetry::startup()
+{
+    int num_routers = m_net_ptr->getNumRouters();
+    m_last_swizzles.assign(num_routers, 0);
+    m_last_bubble_moves.assign(num_routers, 0);
+    m_last_deflections.assign(num_routers, 0);
+    m_last_link_flits.assign(m_net_ptr->get_networklinks_ref().size(), 0);
+
+    m_net_ptr->schedule(m_sample_event, m_net_ptr->clockEdge(m_interval));
+}
+
+void
+NetworkTelemetry::sample()
+{
+    Cycles cur_cycle = m_net_ptr->curCycle();
+    ostream &router_out = *m_router_file->stream();
+    ostream &link_out = *m_link_file->stream();
+
+    bool bubble = m_net_ptr->isEnableSwizzleSwap() &&
+                  m_net_ptr->getPolicy() == MINIMAL_;
+
+    vector<Router *> &routers = m_net_ptr->get_routers_ref();
+    for (int r = 0; r < routers.size(); r++) {
+        Router *router = routers[r];
+
+        int occupied_vcs = 0;
+        vector<InputUnit *> &input_units = router->get_inputUnit_ref();
+        for (int i = 0; i < input_units.size(); i++) {
+            occupied_vcs += input_units[i]->get_num_occupied_vcs();
+        }
+
+        router_out << cur_cycle << ',' << router->get_id() << ','
+                   << occupied_vcs << ',';
+        if (bubble) {
+            router_out << router->critical_inport.id << ','
+                       << router->critical_inport.dirn << ',';
+        } else {
+            router_out << "-1,None,";
+        }
+
+        router_out << router->get_num_swizzles() - m_last_swizzles[r] << ','
+                   << router->get_num_bubble_moves() - m_last_bubble_moves[r]
+                   << ','
+                   << router->get_num_deflections() - m_last_deflections[r]
+                   << '\n';
+
+        m_last_swizzles[r] = router->get_num_swizzles();
+        m_last_bubble_moves[r] = router->get_num_bubble_moves();
+        m_last_deflections[r] = router->get_num_deflections();
+    }
+
+    vector<NetworkLink *> &links = m_net_ptr->get_networklinks_ref();
+    for (int l = 0; l < links.size(); l++) {
+        unsigned int flits = links[l]->getLinkUtilization();
+        // link counters are cleared on a stats reset
+        unsigned int delta = (flits >= m_last_link_flits[l]) ?
+            flits - m_last_link_flits[l] : flits;
+        m_last_link_flits[l] = flits;
+
+        const char *type = "int";
+        if (links[l]->getType() == EXT_IN_)
+            type = "ext_in";
+        else if (links[l]->getType() == EXT_OUT_)
+            type = "ext_out";
+
+        link_out << cur_cycle << ',' << links[l]->get_id() << ','
+                 << type << ',' << delta << '\n';
+    }
+
+    m_net_ptr->schedule(m_sample_event, m_net_ptr->clockEdge(m_interval));
+}
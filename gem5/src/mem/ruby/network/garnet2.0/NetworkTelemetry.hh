@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_NETWORKTELEMETRY_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_NETWORKTELEMETRY_HH__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/types.hh"
+#include "sim/eventq.hh"
+
+class GarnetNetwork;
+
+/*
+ * Periodic per-router and per-link sampling for Garnet.
+ * Every 'interval' cycles one CSV row is appended per router to
+ * <prefix>.routers.csv and one per link to <prefix>.links.csv in the
+ * simulation output directory. Counters are written as deltas over the
+ * sampling interval so rows can be plotted directly as a time series or
+ * summed into a heatmap.
+ */
+class NetworkTelemetry
+{
+  public:
+    NetworkTelemetry(GarnetNetwork *net_ptr, Cycles interval,
+                     const std::string &prefix);
+    ~NetworkTelemetry();
+
+    // schedule the first sample; called once the network is built
+    void startup();
+
+  private:
+    void sample();
+
+    GarnetNetwork *m_net_ptr;
+    Cycles m_interval;
+    EventFunctionWrapper m_sample_event;
+
+    OutputStream *m_router_file;
+    OutputStream *m_link_file;
+
+    // counter values at the previous sample
+    std::vector<unsigned int> m_last_link_flits;
+    std::vector<uint64_t> m_last_swizzles;
+    std::vector<uint64_t> m_last_bubble_moves;
+    std::vector<uint64_t> m_last_deflections;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_NETWORKTELEMETRY_HH__
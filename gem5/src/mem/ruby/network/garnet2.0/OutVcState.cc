@@ -36,16 +36,19 @@
 #include "mem/ruby/system/RubySystem.hh"
 
 OutVcState::OutVcState(int id, GarnetNetwork *network_ptr)
+    : OutVcState(id, network_ptr->get_vnet_type(id) == DATA_VNET_ ?
+                     (int)network_ptr->getBuffersPerDataVC() :
+                     (int)network_ptr->getBuffersPerCtrlVC())
+{
+}
+
+OutVcState::OutVcState(int id, int max_credit_count)
     : m_time(0)
 {
     m_id = id;
     m_vc_state = IDLE_;
     critical_vc = false;
-    if (network_ptr->get_vnet_type(id) == DATA_VNET_)
-        m_max_credit_count = network_ptr->getBuffersPerDataVC();
-    else
-        m_max_credit_count = network_ptr->getBuffersPerCtrlVC();
-
+    m_max_credit_count = max_credit_count;
     m_credit_count = m_max_credit_count;
     assert(m_credit_count >= 1);
 }
@@ -41,6 +41,7 @@ class OutVcState
 {
   public:
     OutVcState(int id, GarnetNetwork *network_ptr);
+    OutVcState(int id, int max_credit_count);
 
     int get_credit_count()          { return m_credit_count; }
     inline bool has_credit()       { return (m_credit_count > 0); }
@@ -36,6 +36,7 @@
 #include "base/stl_helpers.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet2.0/Credit.hh"
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 
 using namespace std;
@@ -50,6 +51,9 @@ OutputUnit::OutputUnit(int id, PortDirection direction, Router *router)
     m_num_vcs = m_router->get_num_vcs();
     m_vc_per_vnet = m_router->get_vc_per_vnet();
     m_out_buffer = new flitBuffer();
+    m_grant_cycle = Cycles(~0ULL);
+    m_reserve_cycle = Cycles(~0ULL);
+    m_escape_vc = m_router->get_net_ptr()->isEscapeVcEnabled();
 
     for (int i = 0; i < m_num_vcs; i++) {
         m_outvc_state.push_back(new OutVcState(i, m_router->get_net_ptr()));
@@ -118,7 +122,9 @@ bool
 OutputUnit::has_free_vc(int vnet)
 {
     int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
+    // Escape-VC mode: the first VC of each vnet is the escape VC
+    int vc_first = vc_base + (m_escape_vc ? 1 : 0);
+    for (int vc = vc_first; vc < vc_base + m_vc_per_vnet; vc++) {
         if (is_vc_idle(vc, m_router->curCycle()) &&
             (is_vc_critical(vc) == false))
             return true;
@@ -132,7 +138,8 @@ int
 OutputUnit::select_free_vc(int vnet)
 {
     int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
+    int vc_first = vc_base + (m_escape_vc ? 1 : 0);
+    for (int vc = vc_first; vc < vc_base + m_vc_per_vnet; vc++) {
         if (is_vc_idle(vc, m_router->curCycle()) &&
             (is_vc_critical(vc) == false)) {
             m_outvc_state[vc]->setState(ACTIVE_, m_router->curCycle());
@@ -143,6 +150,27 @@ OutputUnit::select_free_vc(int vnet)
     return -1;
 }
 
+// Escape-VC mode: check the escape VC of this vnet
+bool
+OutputUnit::has_free_escape_vc(int vnet)
+{
+    int vc = vnet*m_vc_per_vnet;
+    return (is_vc_idle(vc, m_router->curCycle()) &&
+            (is_vc_critical(vc) == false));
+}
+
+// Escape-VC mode: assign the escape VC of this vnet
+int
+OutputUnit::select_free_escape_vc(int vnet)
+{
+    if (!has_free_escape_vc(vnet))
+        return -1;
+
+    int vc = vnet*m_vc_per_vnet;
+    m_outvc_state[vc]->setState(ACTIVE_, m_router->curCycle());
+    return vc;
+}
+
 /*
  * The wakeup function of the OutputUnit reads the credit signal from the
  * downstream router for the output VC (i.e., input VC at downstream router).
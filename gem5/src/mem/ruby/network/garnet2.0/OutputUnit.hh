@@ -61,6 +61,8 @@ class OutputUnit : public Consumer
     bool chk_has_credit(int out_vc);
     bool has_free_vc(int vnet);
     int select_free_vc(int vnet);
+    bool has_free_escape_vc(int vnet);
+    int select_free_escape_vc(int vnet);
 
     inline PortDirection get_direction() { return m_direction; }
 
@@ -106,6 +108,18 @@ class OutputUnit : public Consumer
         m_out_link->scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
     }
 
+    // SMART: an output port is either granted to a local flit by SA-II
+    // or reserved for a flit bypassing this router; never both.
+    inline void mark_granted(Cycles curTime) { m_grant_cycle = curTime; }
+    inline void mark_reserved(Cycles curTime) { m_reserve_cycle = curTime; }
+    inline bool is_reserved(Cycles curTime)
+    { return m_reserve_cycle == curTime; }
+    inline bool
+    is_busy(Cycles curTime)
+    {
+        return (m_grant_cycle == curTime || m_reserve_cycle == curTime);
+    }
+
     uint32_t functionalWrite(Packet *pkt);
 
     int getNumFreeVCs(int vnet)
@@ -119,6 +133,16 @@ class OutputUnit : public Consumer
         return freeVC;
     }
 
+    // free buffer slots downstream, summed over the VCs of a vnet
+    int getNumFreeSlots(int vnet)
+    {
+        int slots = 0;
+        int vc_base = vnet*m_vc_per_vnet;
+        for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++)
+            slots += get_credit_count(vc);
+        return slots;
+    }
+
   private:
     int m_id;
     PortDirection m_direction;
@@ -131,6 +155,11 @@ class OutputUnit : public Consumer
     flitBuffer *m_out_buffer; // This is for the network link to consume
     std::vector<OutVcState *> m_outvc_state; // vc state of downstream router
 
+    Cycles m_grant_cycle;   // last cycle SA-II granted this port
+    Cycles m_reserve_cycle; // last cycle a SMART bypass reserved this port
+    // Escape-VC mode: VC 0 of each vnet is kept out of adaptive allocation
+    bool m_escape_vc;
+
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET2_0_OUTPUTUNIT_HH__
@@ -33,6 +33,8 @@
 
 #include "mem/ruby/network/garnet2.0/Router.hh"
 
+#include <algorithm>
+
 #include "base/stl_helpers.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
@@ -42,6 +44,7 @@
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
 #include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
+#include "mem/ruby/network/garnet2.0/SpinRecovery.hh"
 #include "mem/ruby/network/garnet2.0/SwitchAllocator.hh"
 
 using namespace std;
@@ -62,6 +65,11 @@ Router::Router(const Params *p)
     critical_inport.id = -1;
     critical_inport.dirn = "Unknown";
     critical_inport.send_credit = false;
+    m_num_swizzles = 0;
+    m_num_bubble_moves = 0;
+    m_num_deflections = 0;
+    m_recovery_flits = 0;
+    m_bypass_flits = 0;
 
     m_routing_unit = new RoutingUnit(this);
     m_sw_alloc = new SwitchAllocator(this);
@@ -121,6 +129,8 @@ void Router::critical_swap(int critical_inport_id, int inport_id)
     // doSwap.. just set the inport-vc active and idle accordingly..
     flit *t_flit;
     t_flit =  m_input_unit[inport_id]->getTopFlit(0);
+    get_net_ptr()->record_recovery(1, blocked_cycles(t_flit));
+    add_recovery_flits(1);
     // insert the flit..
     m_input_unit[critical_inport_id]->insertFlit(0,t_flit);
 
@@ -212,6 +222,11 @@ void Router::bubble_deflect()
 
                 t_flit1 = m_input_unit[inp_]->getTopFlit(0);
                 t_flit2 = upstream_inpUnit[upstrm_inp_]->getTopFlit(0);
+                get_net_ptr()->record_recovery(2,
+                    std::max(blocked_cycles(t_flit1),
+                             blocked_cycles(t_flit2)));
+                add_recovery_flits(1);
+                upstream_->add_recovery_flits(1);
                 // Route computer for these flit respectively
 
                 int outport2 = route_compute(t_flit2->get_route(),
@@ -238,6 +253,7 @@ void Router::bubble_deflect()
                 // update the stats:
                 get_net_ptr()->num_routed_bubbleSwaps++;
                 get_net_ptr()->num_bubbleSwaps++;
+                m_num_deflections++;
                 // return
                 return;
             }
@@ -260,6 +276,11 @@ void Router::bubble_deflect()
 
                     t_flit1 = m_input_unit[inp_]->getTopFlit(0);
                     t_flit2 = upstream_inpUnit[upstrm_inp_]->getTopFlit(0);
+                    get_net_ptr()->record_recovery(2,
+                        std::max(blocked_cycles(t_flit1),
+                                 blocked_cycles(t_flit2)));
+                    add_recovery_flits(1);
+                    upstream_->add_recovery_flits(1);
 
                     // Swap
                     int outport2 = route_compute(t_flit2->get_route(),
@@ -284,6 +305,7 @@ void Router::bubble_deflect()
                     #endif
                     // Stats
                     get_net_ptr()->num_bubbleSwaps++;
+                    m_num_deflections++;
                     // return
                     return;
                 }
@@ -454,6 +476,7 @@ Router::wakeup()
                 // Not counting the bubble-movement with empty slot
                 // as it doesn't consume energy.
                 // get_net_ptr()->num_bubbleSwizzles++;
+                m_num_bubble_moves++;
 
                 #if (MY_PRINT)
                 cout << "Swizzle completed with empty input-port..." << endl;
@@ -461,6 +484,7 @@ Router::wakeup()
             }
             else if (success == 2) {
                 get_net_ptr()->num_bubbleSwizzles++;
+                m_num_swizzles++;
                 #if (MY_PRINT)
                 cout << "Swizzle completed with flit with differnt outport"<< endl;
                 #endif
@@ -497,6 +521,9 @@ Router::wakeup()
                 }
 
             }
+        } // option-3: synchronized spin
+        else if(get_net_ptr()->getPolicy() == SPIN_) {
+            get_net_ptr()->get_spin_recovery()->check_timeouts(this);
         } // option-2: Non-Minimal
         else if(get_net_ptr()->getPolicy() == NON_MINIMAL_) {
             // Deflection...
@@ -671,6 +698,14 @@ int Router::swapInport() {
 }
 
 
+// Cycles a buffered flit has been waiting for SA
+Cycles
+Router::blocked_cycles(flit *t_flit)
+{
+    Cycles ready = t_flit->get_stage().second;
+    return (ready < curCycle()) ? Cycles(curCycle() - ready) : Cycles(0);
+}
+
 int
 Router::get_numFreeVC(PortDirection dirn_) {
     // Caution: This 'dirn_' is the direction of inport
@@ -737,12 +772,131 @@ Router::route_compute(RouteInfo route, int inport, PortDirection inport_dirn)
     return m_routing_unit->outportCompute(route, inport, inport_dirn);
 }
 
+// Escape-VC mode: outport of the escape sub-network at this router
+int
+Router::escape_route_compute(RouteInfo route, int inport,
+                             PortDirection inport_dirn)
+{
+    return m_routing_unit->outportComputeEscape(route, inport, inport_dirn);
+}
+
+// Compute the multicast branches of a flit at this router and
+// return the outport of the first one.
+int
+Router::route_compute_multicast(flit *t_flit, int inport,
+                                PortDirection inport_dirn)
+{
+    std::vector<std::pair<int, NetDest> > &branches = t_flit->get_branches();
+    m_routing_unit->outportComputeMulticast(t_flit->get_route(), inport,
+                                            inport_dirn, branches);
+    int outport = branches.front().first;
+    if (branches.size() == 1) {
+        // all destinations leave through the same outport
+        branches.clear();
+    }
+    return outport;
+}
+
 void
 Router::grant_switch(int inport, flit *t_flit)
 {
     m_switch->update_sw_winner(inport, t_flit);
 }
 
+// Check if any flit at this router is ready for SA this cycle
+// and will request the given outport.
+bool
+Router::has_sa_request(int outport)
+{
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        for (int vc = 0; vc < m_num_vcs; vc++) {
+            if (m_input_unit[inport]->need_stage(vc, SA_, curCycle()) &&
+                m_input_unit[inport]->peekTopFlit(vc)->get_outport() ==
+                    outport)
+                return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * SMART: try to extend the traversal of a flit that just won SA at
+ * this router across up to (HPCmax - 1) downstream routers in the
+ * same direction within this cycle. A downstream router is bypassed
+ * only if
+ * (1) the packet continues straight through it,
+ * (2) its input port from this direction holds no flits, so the
+ *     crossbar input is free,
+ * (3) no local flit ready for SA wants the same output port, and
+ *     the output port has not been granted or reserved this cycle,
+ * (4) the output port has a free VC (critical VCs are excluded,
+ *     so the bubble of swizzleSwap is never taken).
+ * Local flits are given priority over bypassing flits by (3).
+ * Output ports along the path are reserved for this cycle.
+ * Returns the output unit of the last bypassed router (the flit is
+ * buffered at its downstream neighbour), or NULL if no router
+ * could be bypassed.
+ */
+OutputUnit*
+Router::smart_bypass_path(flit *t_flit, int outport, int &num_bypassed)
+{
+    num_bypassed = 0;
+    int hpc_max = m_network_ptr->getSmartHpcMax();
+
+    // Only single-flit unicast packets in unordered vnets on a mesh
+    // are bypassed: multi-flit packets would need their body flits to
+    // follow the same path, and ordered vnets could be reordered.
+    if (hpc_max <= 1 || t_flit->get_type() != HEAD_TAIL_ ||
+        t_flit->is_multicast() ||
+        m_network_ptr->isVNetOrdered(t_flit->get_vnet()) ||
+        m_network_ptr->getNumRows() <= 0)
+        return NULL;
+
+    PortDirection dirn = getOutportDirection(outport);
+    if (dirn != "North" && dirn != "South" &&
+        dirn != "East" && dirn != "West")
+        return NULL;
+    PortDirection in_dirn = input_output_dirn_map(dirn);
+
+    int vnet = t_flit->get_vnet();
+    RouteInfo route = t_flit->get_route();
+    Router *router = this;
+    OutputUnit *bypass_unit = NULL;
+
+    for (int hop = 1; hop < hpc_max; hop++) {
+        Router *next = m_network_ptr->get_RouterInDirn(dirn,
+                                                       router->get_id());
+        RoutingUnit *ru = next->m_routing_unit;
+
+        if (ru->m_inports_dirn2idx.count(in_dirn) == 0 ||
+            ru->m_outports_dirn2idx.count(dirn) == 0)
+            break;
+        int next_inport = ru->m_inports_dirn2idx[in_dirn];
+        int next_outport = ru->m_outports_dirn2idx[dirn];
+
+        if (!next->get_inputUnit_ref()[next_inport]->isEmpty())
+            break;
+
+        if (next->route_compute(route, next_inport, in_dirn) !=
+            next_outport)
+            break;
+
+        OutputUnit *out_unit = next->get_outputUnit_ref()[next_outport];
+        if (out_unit->is_busy(curCycle()) ||
+            !out_unit->has_free_vc(vnet) ||
+            next->has_sa_request(next_outport))
+            break;
+
+        out_unit->mark_reserved(curCycle());
+        next->add_bypass_flit();
+        bypass_unit = out_unit;
+        router = next;
+        num_bypassed++;
+    }
+
+    return bypass_unit;
+}
+
 void
 Router::schedule_wakeup(Cycles time)
 {
@@ -789,6 +943,26 @@ Router::regStats()
         .name(name() + ".sw_output_arbiter_activity")
         .flags(Stats::nozero)
     ;
+
+    m_dynamic_energy
+        .name(name() + ".dynamic_energy")
+        .flags(Stats::nozero)
+    ;
+
+    m_leakage_energy
+        .name(name() + ".leakage_energy")
+        .flags(Stats::nozero)
+    ;
+
+    m_recovery_energy
+        .name(name() + ".recovery_energy")
+        .flags(Stats::nozero)
+    ;
+
+    m_power
+        .name(name() + ".power")
+        .flags(Stats::nozero)
+    ;
 }
 
 void
@@ -806,6 +980,40 @@ Router::collateStats()
     m_crossbar_activity = m_switch->get_crossbar_activity();
 }
 
+// Activity counts from collateStats() times the per-event energies, plus
+// leakage of every flit buffer and port over the window. A flit that
+// bypasses this router (SMART) still crosses its crossbar.
+void
+Router::collateEnergy(double time_ns)
+{
+    const NocEnergyModel &energy = m_network_ptr->getEnergyModel();
+
+    m_recovery_energy = m_recovery_flits * energy.recovery_move;
+    m_dynamic_energy =
+        m_buffer_reads.value() * energy.buffer_read +
+        m_buffer_writes.value() * energy.buffer_write +
+        (m_sw_input_arbiter_activity.value() +
+         m_sw_output_arbiter_activity.value()) * energy.sw_arbiter +
+        (m_crossbar_activity.value() + m_bypass_flits) * energy.crossbar +
+        m_recovery_energy.value();
+
+    int num_buffers = 0;
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        num_buffers += (m_network_ptr->get_vnet_type(vc) == DATA_VNET_) ?
+            m_network_ptr->getBuffersPerDataVC() :
+            m_network_ptr->getBuffersPerCtrlVC();
+    }
+    num_buffers *= m_input_unit.size();
+    int num_ports = m_input_unit.size() + m_output_unit.size();
+    m_leakage_energy = (num_buffers * energy.buffer_leakage +
+                        num_ports * energy.port_leakage) * time_ns;
+
+    if (time_ns > 0.0) {
+        m_power = (m_dynamic_energy.value() + m_leakage_energy.value()) /
+            time_ns;
+    }
+}
+
 void
 Router::resetStats()
 {
@@ -817,6 +1025,8 @@ Router::resetStats()
 
     m_switch->resetStats();
     m_sw_alloc->resetStats();
+    m_recovery_flits = 0;
+    m_bypass_flits = 0;
 }
 
 void
@@ -96,6 +96,14 @@ class Router : public BasicRouter, public Consumer
             return "East";
         else if(dirn == "South")
             return "North";
+        else if(dirn == "NorthExpress")
+            return "SouthExpress";
+        else if(dirn == "EastExpress")
+            return "WestExpress";
+        else if(dirn == "WestExpress")
+            return "EastExpress";
+        else if(dirn == "SouthExpress")
+            return "NorthExpress";
         else
             assert(0);
     }
@@ -106,7 +114,16 @@ class Router : public BasicRouter, public Consumer
     PortDirection getInportDirection(int inport);
 
     int route_compute(RouteInfo route, int inport, PortDirection direction);
+    int escape_route_compute(RouteInfo route, int inport,
+                             PortDirection direction);
+    int route_compute_multicast(flit *t_flit, int inport,
+                                PortDirection direction);
     void grant_switch(int inport, flit *t_flit);
+
+    // SMART multi-hop bypass
+    bool has_sa_request(int outport);
+    OutputUnit* smart_bypass_path(flit *t_flit, int outport,
+                                  int &num_bypassed);
     void schedule_wakeup(Cycles time);
 
     std::string getPortDirectionName(PortDirection direction);
@@ -116,6 +133,15 @@ class Router : public BasicRouter, public Consumer
     void regStats();
     void collateStats();
     void resetStats();
+    // energy over a stats window of time_ns (see NocEnergyModel)
+    void collateEnergy(double time_ns);
+    double get_dynamic_energy() { return m_dynamic_energy.value(); }
+    double get_leakage_energy() { return m_leakage_energy.value(); }
+    double get_recovery_energy() { return m_recovery_energy.value(); }
+    // flits moved into this router by a swap, deflection or spin
+    void add_recovery_flits(int num_flits) { m_recovery_flits += num_flits; }
+    // a flit crossed this router on a SMART bypass
+    void add_bypass_flit() { m_bypass_flits++; }
 
     // swizzleSwap structure
     int swapInport();
@@ -123,6 +149,11 @@ class Router : public BasicRouter, public Consumer
     void critical_swap(int critical_inport_id, int inport_id);
     bool chk_critical_deflect(int my_id);
     int get_numFreeVC(PortDirection dirn_);
+    Cycles blocked_cycles(flit *t_flit);
+    // per-router bubble activity (sampled by NetworkTelemetry)
+    uint64_t get_num_swizzles() const { return m_num_swizzles; }
+    uint64_t get_num_bubble_moves() const { return m_num_bubble_moves; }
+    uint64_t get_num_deflections() const { return m_num_deflections; }
     uint32_t inport_occupancy; // at any point it tells number of inport occupied
                                 // of this router
     bool is_critical; // tells if this router is cretical => has a free inport
@@ -185,6 +216,11 @@ class Router : public BasicRouter, public Consumer
   private:
     Cycles m_latency;
     int m_virtual_networks, m_num_vcs, m_vc_per_vnet;
+    uint64_t m_num_swizzles;      // swaps with a buffered flit
+    uint64_t m_num_bubble_moves;  // swaps with an empty inport
+    uint64_t m_num_deflections;   // successful bubble deflections
+    uint64_t m_recovery_flits;    // flits moved by deadlock recovery
+    uint64_t m_bypass_flits;      // flits that bypassed this router (SMART)
     GarnetNetwork *m_network_ptr;
 
     std::vector<InputUnit *> m_input_unit;
@@ -200,6 +236,12 @@ class Router : public BasicRouter, public Consumer
     Stats::Scalar m_sw_output_arbiter_activity;
 
     Stats::Scalar m_crossbar_activity;
+
+    // energy (pJ) and power (mW)
+    Stats::Scalar m_dynamic_energy;
+    Stats::Scalar m_leakage_energy;
+    Stats::Scalar m_recovery_energy;
+    Stats::Scalar m_power;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET2_0_ROUTER_HH__
@@ -198,6 +198,8 @@ int RoutingUnit::outportCompute(RouteInfo route, int inport,
             outportComputeAdaptWestFirst(route, inport, inport_dirn); break;
         case DEFLECTION_: outport =
             outportComputeXY_Deflection(route, inport, inport_dirn); break;
+        case EXPRESS_XY_: outport =
+            outportComputeExpressXY(route, inport, inport_dirn); break;
         // any custom algorithm
         case CUSTOM_: outport =
             outportComputeCustom(route, inport, inport_dirn); break;
@@ -209,12 +211,79 @@ int RoutingUnit::outportCompute(RouteInfo route, int inport,
     return outport;
 }
 
+// Escape-VC (Duato) mode: outport of the deadlock-free escape
+// sub-network. The escape VC of every vnet is routed XY, so its channel
+// dependency graph is acyclic; the other VCs use outportCompute().
+int
+RoutingUnit::outportComputeEscape(RouteInfo route, int inport,
+                                  PortDirection inport_dirn)
+{
+    if (route.dest_router == m_router->get_id())
+        return lookupRoutingTable(route.vnet, route.net_dest);
+
+    return outportComputeXY(route, inport, inport_dirn);
+}
+
+// Multicast routing: a tree is formed by routing every destination of
+// the packet with the configured (unicast) algorithm and forking the
+// packet wherever destinations leave through different outports.
+void
+RoutingUnit::outportComputeMulticast(RouteInfo route, int inport,
+                            PortDirection inport_dirn,
+                            std::vector<std::pair<int, NetDest> > &branches)
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    std::vector<NodeID> dest_nodes = route.net_dest.getAllDest();
+    branches.clear();
+
+    for (int i = 0; i < dest_nodes.size(); i++) {
+        RouteInfo dest_route = route;
+        dest_route.net_dest = net_ptr->get_personal_dest(dest_nodes[i]);
+        dest_route.dest_ni = dest_nodes[i];
+        dest_route.dest_router = net_ptr->get_router_id(dest_nodes[i]);
+
+        int outport = outportCompute(dest_route, inport, inport_dirn);
+
+        int b = 0;
+        for (; b < branches.size(); b++) {
+            if (branches[b].first == outport) {
+                branches[b].second.addNetDest(dest_route.net_dest);
+                break;
+            }
+        }
+        if (b == branches.size())
+            branches.push_back(std::make_pair(outport, dest_route.net_dest));
+    }
+    assert(!branches.empty());
+}
+
 // XY routing implemented using port directions
 // Only for reference purpose in a Mesh
 // By default Garnet uses the routing table
 int RoutingUnit::outportComputeXY(RouteInfo route,
                               int inport,
                               PortDirection inport_dirn)
+{
+    int M5_VAR_USED num_rows = m_router->get_net_ptr()->getNumRows();
+    int num_cols = m_router->get_net_ptr()->getNumCols();
+    assert(num_rows > 0 && num_cols > 0);
+
+    // already checked in outportCompute() that this is not the
+    // destination router
+    PortDirection outport_dirn =
+        xyDirection(m_router->get_id(), route.dest_router, num_cols);
+
+    return m_outports_dirn2idx[outport_dirn];
+}
+
+// XY routing over express links (see configs/topologies/Mesh_express.py)
+// The dimension order is the same as XY. Within a dimension the express
+// link in that direction is taken whenever it exists at this router and
+// does not overshoot the destination, so every hop still moves the packet
+// monotonically towards it and XY deadlock freedom is preserved.
+int RoutingUnit::outportComputeExpressXY(RouteInfo route,
+                              int inport,
+                              PortDirection inport_dirn)
 {
     PortDirection outport_dirn = "Unknown";
 
@@ -239,29 +308,21 @@ int RoutingUnit::outportComputeXY(RouteInfo route,
     // already checked that in outportCompute() function
     assert(!(x_hops == 0 && y_hops == 0));
 
-    if (x_hops > 0) {
-        if (x_dirn) {
-            // assert(inport_dirn == "Local" || inport_dirn == "West");
-            outport_dirn = "East";
-        } else {
-            // assert(inport_dirn == "Local" || inport_dirn == "East");
-            outport_dirn = "West";
-        }
-    } else if (y_hops > 0) {
-        if (y_dirn) {
-            // "Local" or "South" or "West" or "East"
-            // assert(inport_dirn != "North");
-            outport_dirn = "North";
-        } else {
-            // "Local" or "North" or "West" or "East"
-            // assert(inport_dirn != "South");
-            outport_dirn = "South";
-        }
-    } else {
-        // x_hops == 0 and y_hops == 0
-        // this is not possible
-        // already checked that in outportCompute() function
-        assert(0);
+    if (x_hops > 0)
+        outport_dirn = x_dirn ? "East" : "West";
+    else
+        outport_dirn = y_dirn ? "North" : "South";
+
+    PortDirection express_dirn = outport_dirn + "Express";
+    if (m_outports_dirn2idx.count(express_dirn)) {
+        int hop_id = m_router->get_net_ptr()->
+            get_RouterInDirn(express_dirn, my_id)->get_id();
+        int hop_x = hop_id % num_cols;
+        int hop_y = hop_id / num_cols;
+
+        if ((x_hops > 0 && abs(hop_x - my_x) <= x_hops) ||
+            (x_hops == 0 && abs(hop_y - my_y) <= y_hops))
+            outport_dirn = express_dirn;
     }
 
     return m_outports_dirn2idx[outport_dirn];
@@ -34,6 +34,8 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET2_0_ROUTINGUNIT_HH__
 #define __MEM_RUBY_NETWORK_GARNET2_0_ROUTINGUNIT_HH__
 
+#include <cassert>
+
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
@@ -67,6 +69,23 @@ class RoutingUnit
                          int inport,
                          PortDirection inport_dirn);
 
+    // Direction XY routing takes from router my_id towards router
+    // dest_id in a mesh with num_cols columns (my_id != dest_id)
+    static PortDirection
+    xyDirection(int my_id, int dest_id, int num_cols)
+    {
+        int my_x = my_id % num_cols;
+        int my_y = my_id / num_cols;
+        int dest_x = dest_id % num_cols;
+        int dest_y = dest_id / num_cols;
+
+        if (dest_x != my_x)
+            return (dest_x > my_x) ? "East" : "West";
+
+        assert(dest_y != my_y);
+        return (dest_y > my_y) ? "North" : "South";
+    }
+
     // Routing for Mesh
     int outportComputeRandom(RouteInfo route,
                          int inport,
@@ -86,6 +105,23 @@ class RoutingUnit
                             int inport,
                             PortDirection inport_dirn);
 
+    // XY routing over a Mesh with express links
+    int outportComputeExpressXY(RouteInfo route,
+                            int inport,
+                            PortDirection inport_dirn);
+
+    // Escape-VC mode: XY outport used by the escape VC of each vnet
+    int outportComputeEscape(RouteInfo route,
+                            int inport,
+                            PortDirection inport_dirn);
+
+    // Multicast: outport of every destination of the route,
+    // grouped into one branch per outport
+    void outportComputeMulticast(RouteInfo route,
+                            int inport,
+                            PortDirection inport_dirn,
+                            std::vector<std::pair<int, NetDest> > &branches);
+
     int numFreeVC(PortDirection dirn_);
     // Custom Routing Algorithm using Port Directions
     int outportComputeCustom(RouteInfo route,
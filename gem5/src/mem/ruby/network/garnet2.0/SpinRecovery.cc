@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/garnet2.0/SpinRecovery.hh"
+
+#include <algorithm>
+
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet2.0/InputUnit.hh"
+#include "mem/ruby/network/garnet2.0/Router.hh"
+#include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
+#include "mem/ruby/network/garnet2.0/flit.hh"
+
+using namespace std;
+
+SpinRecovery::SpinRecovery(GarnetNetwork *net_ptr, Cycles timeout)
+    : m_net_ptr(net_ptr), m_timeout(timeout),
+      m_spin_event([this]{ process_spins(); }, "Garnet SPIN recovery"),
+      m_max_path(0)
+{
+    assert(m_timeout > Cycles(0));
+}
+
+SpinRecovery::~SpinRecovery()
+{
+    if (m_spin_event.scheduled())
+        m_net_ptr->deschedule(m_spin_event);
+}
+
+void
+SpinRecovery::startup()
+{
+    vector<Router *> &routers = m_net_ptr->get_routers_ref();
+    m_last_probe.resize(routers.size());
+    for (int r = 0; r < routers.size(); r++) {
+        int num_vcs = routers[r]->get_num_vcs();
+        m_last_probe[r].assign(routers[r]->get_num_inports() * num_vcs,
+                               Cycles(0));
+        m_max_path += routers[r]->get_num_inports() * num_vcs;
+    }
+}
+
+void
+SpinRecovery::check_timeouts(Router *router)
+{
+    Cycles cur_cycle = router->curCycle();
+    int num_vcs = router->get_num_vcs();
+    vector<InputUnit *> &input_units = router->get_inputUnit_ref();
+    vector<Cycles> &last_probe = m_last_probe[router->get_id()];
+
+    for (int inport = 0; inport < input_units.size(); inport++) {
+        for (int vc = 0; vc < num_vcs; vc++) {
+            if (!input_units[inport]->need_stage(vc, SA_, cur_cycle))
+                continue;
+
+            flit *t_flit = input_units[inport]->peekTopFlit(vc);
+            Cycles since = max(t_flit->get_stage().second,
+                               last_probe[inport * num_vcs + vc]);
+            if (cur_cycle - since < m_timeout)
+                continue;
+
+            last_probe[inport * num_vcs + vc] = cur_cycle;
+            m_net_ptr->num_spin_probes++;
+
+            Spin spin;
+            if (!find_cycle(router, inport, vc, spin.cycle))
+                continue;
+
+            m_net_ptr->num_spin_deadlocks++;
+            spin.time = cur_cycle + Cycles(2 * spin.cycle.size());
+            m_pending.push_back(spin);
+            schedule_next();
+        }
+    }
+}
+
+// Follow the dependency chain of the flit at (router, inport, vc).
+// Returns true with the positions of the cycle it runs into.
+bool
+SpinRecovery::find_cycle(Router *router, int inport, int vc,
+                         vector<Position> &cycle)
+{
+    Cycles cur_cycle = router->curCycle();
+    vector<Position> path;
+
+    for (int hop = 0; hop < m_max_path; hop++) {
+        // the chain closes on itself
+        for (int i = 0; i < path.size(); i++) {
+            if (path[i].router == router && path[i].inport == inport &&
+                path[i].vc == vc) {
+                cycle.assign(path.begin() + i, path.end());
+                return true;
+            }
+        }
+
+        InputUnit *input_unit = router->get_inputUnit_ref()[inport];
+        if (!input_unit->need_stage(vc, SA_, cur_cycle) ||
+            is_locked(router, inport, vc))
+            return false;
+
+        flit *t_flit = input_unit->peekTopFlit(vc);
+        if (t_flit->get_type() != HEAD_TAIL_)
+            return false;
+
+        PortDirection outport_dirn =
+            router->getOutportDirection(t_flit->get_outport());
+        if (outport_dirn == "Local")
+            return false;
+
+        Position pos = { router, inport, vc, t_flit };
+        path.push_back(pos);
+
+        // move to the input port the flit is waiting for
+        Router *next = m_net_ptr->get_RouterInDirn(outport_dirn,
+                                                   router->get_id());
+        PortDirection inport_dirn =
+            router->input_output_dirn_map(outport_dirn);
+        map<PortDirection, int> &inports =
+            next->m_routing_unit->m_inports_dirn2idx;
+        if (inports.count(inport_dirn) == 0)
+            return false;
+        router = next;
+        inport = inports[inport_dirn];
+        input_unit = router->get_inputUnit_ref()[inport];
+
+        // the flit is only blocked if every VC of its vnet is occupied;
+        // follow the one that has been waiting longest
+        int vc_per_vnet = router->get_vc_per_vnet();
+        int vc_base = (vc / vc_per_vnet) * vc_per_vnet;
+        int oldest = -1;
+        Cycles oldest_time = Cycles(0);
+        for (int v = vc_base; v < vc_base + vc_per_vnet; v++) {
+            if (input_unit->vc_isEmpty(v))
+                return false;
+            Cycles time = input_unit->peekTopFlit(v)->get_stage().second;
+            if (oldest == -1 || time < oldest_time) {
+                oldest = v;
+                oldest_time = time;
+            }
+        }
+        vc = oldest;
+    }
+
+    return false;
+}
+
+bool
+SpinRecovery::is_locked(Router *router, int inport, int vc)
+{
+    for (int s = 0; s < m_pending.size(); s++) {
+        const vector<Position> &cycle = m_pending[s].cycle;
+        for (int i = 0; i < cycle.size(); i++) {
+            if (cycle[i].router == router && cycle[i].inport == inport &&
+                cycle[i].vc == vc)
+                return true;
+        }
+    }
+    return false;
+}
+
+// The cycle still holds: every flit is where the probe found it and
+// still waiting for SA.
+bool
+SpinRecovery::is_valid(const Spin &spin)
+{
+    for (int i = 0; i < spin.cycle.size(); i++) {
+        const Position &pos = spin.cycle[i];
+        InputUnit *input_unit = pos.router->get_inputUnit_ref()[pos.inport];
+        if (!input_unit->need_stage(pos.vc, SA_, pos.router->curCycle()) ||
+            input_unit->peekTopFlit(pos.vc) != pos.t_flit)
+            return false;
+    }
+    return true;
+}
+
+void
+SpinRecovery::rotate(const Spin &spin)
+{
+    int len = spin.cycle.size();
+    Cycles cur_cycle = m_net_ptr->curCycle();
+    Cycles latency = Cycles(0);
+
+    vector<flit *> flits(len);
+    for (int i = 0; i < len; i++) {
+        const Position &pos = spin.cycle[i];
+        flits[i] = pos.router->get_inputUnit_ref()[pos.inport]->
+            getTopFlit(pos.vc);
+        latency = max(latency,
+                      Cycles(cur_cycle - flits[i]->get_stage().second));
+    }
+
+    // flit i takes the VC of flit i + 1, which is at its next hop
+    for (int i = 0; i < len; i++) {
+        const Position &dst = spin.cycle[(i + 1) % len];
+        InputUnit *input_unit = dst.router->get_inputUnit_ref()[dst.inport];
+        flit *t_flit = flits[i];
+
+        t_flit->increment_hops();
+        t_flit->set_vc(dst.vc);
+        int outport = dst.router->route_compute(t_flit->get_route(),
+            dst.inport, dst.router->getInportDirection(dst.inport));
+        t_flit->set_outport(outport);
+        t_flit->set_outport_dir(dst.router->getOutportDirection(outport));
+
+        input_unit->insertFlit(dst.vc, t_flit);
+        dst.router->add_recovery_flits(1);
+        input_unit->set_vc_active(dst.vc, cur_cycle);
+        input_unit->grant_outport(dst.vc, outport);
+        input_unit->grant_outvc(dst.vc, -1);
+
+        // one hop of link traversal
+        t_flit->advance_stage(SA_, cur_cycle + Cycles(1));
+        dst.router->schedule_wakeup(Cycles(1));
+    }
+
+    m_net_ptr->num_spins++;
+    m_net_ptr->record_recovery(len, latency);
+}
+
+void
+SpinRecovery::process_spins()
+{
+    Cycles cur_cycle = m_net_ptr->curCycle();
+
+    for (int s = 0; s < m_pending.size(); ) {
+        if (m_pending[s].time > cur_cycle) {
+            s++;
+            continue;
+        }
+
+        if (is_valid(m_pending[s]))
+            rotate(m_pending[s]);
+        else
+            m_net_ptr->num_spin_aborts++;
+
+        m_pending.erase(m_pending.begin() + s);
+    }
+
+    schedule_next();
+}
+
+void
+SpinRecovery::schedule_next()
+{
+    if (m_pending.empty())
+        return;
+
+    Cycles next = m_pending[0].time;
+    for (int s = 1; s < m_pending.size(); s++)
+        next = min(next, m_pending[s].time);
+
+    Tick when = m_net_ptr->clockEdge(next - m_net_ptr->curCycle());
+    if (m_spin_event.scheduled()) {
+        if (m_spin_event.when() <= when)
+            return;
+        m_net_ptr->deschedule(m_spin_event);
+    }
+    m_net_ptr->schedule(m_spin_event, when);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_SPINRECOVERY_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_SPINRECOVERY_HH__
+
+#include <vector>
+
+#include "base/types.hh"
+#include "sim/eventq.hh"
+
+class GarnetNetwork;
+class Router;
+class flit;
+
+/*
+ * Synchronized-spin deadlock recovery (policy 3, SPIN_), the coordinated
+ * alternative to the local swizzle-swap of the bubble scheme.
+ * - Detection: a head flit that has waited 'timeout' cycles in SA sends
+ *   a probe. A flit probes again only after another timeout.
+ * - Probe: follows the dependency chain; from a blocked flit to its
+ *   outport, to the input port of the downstream router, and on to the
+ *   oldest flit in the (fully occupied) VCs of its vnet there. The chain
+ *   ends at a free VC or an ejecting flit, or closes into a cycle.
+ * - Spin: every flit of the cycle moves one hop forward at the same
+ *   time, into the VC of the next flit. The VCs stay occupied, so no
+ *   credit or VC state changes upstream.
+ * Probe and move messages cost one cycle per hop, so a spin happens
+ * 2 x (cycle length) cycles after detection, provided that no flit of
+ * the cycle has moved in the meantime. Spins that share no VC may be
+ * pending at the same time. Only single-flit packets are spun.
+ */
+class SpinRecovery
+{
+  public:
+    SpinRecovery(GarnetNetwork *net_ptr, Cycles timeout);
+    ~SpinRecovery();
+
+    void startup();
+
+    // called by a router every time it wakes up
+    void check_timeouts(Router *router);
+
+  private:
+    struct Position
+    {
+        Router *router;
+        int inport;
+        int vc;
+        flit *t_flit;
+    };
+
+    struct Spin
+    {
+        Cycles time;
+        std::vector<Position> cycle;
+    };
+
+    bool find_cycle(Router *router, int inport, int vc,
+                    std::vector<Position> &cycle);
+    bool is_locked(Router *router, int inport, int vc);
+    bool is_valid(const Spin &spin);
+    void rotate(const Spin &spin);
+    void process_spins();
+    void schedule_next();
+
+    GarnetNetwork *m_net_ptr;
+    Cycles m_timeout;
+    EventFunctionWrapper m_spin_event;
+
+    // upper bound of a dependency chain: every VC of the network
+    int m_max_path;
+    // [router][inport * vcs + vc]: cycle of the last probe
+    std::vector<std::vector<Cycles> > m_last_probe;
+    std::vector<Spin> m_pending;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_SPINRECOVERY_HH__
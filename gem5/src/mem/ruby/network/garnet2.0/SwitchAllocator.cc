@@ -33,6 +33,8 @@
 
 #include "mem/ruby/network/garnet2.0/SwitchAllocator.hh"
 
+#include <algorithm>
+
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
@@ -60,23 +62,32 @@ SwitchAllocator::init()
 
     m_num_inports = m_router->get_num_inports();
     m_num_outports = m_router->get_num_outports();
+    m_arbitration =
+        (SaArbitration) m_router->get_net_ptr()->getSaArbitration();
+    m_starvation_threshold =
+        m_router->get_net_ptr()->getSaStarvationThreshold();
     m_round_robin_inport.resize(m_num_outports);
     m_round_robin_invc.resize(m_num_inports);
+    m_starvation.resize(m_num_inports);
     m_port_requests.resize(m_num_outports);
     m_vc_winners.resize(m_num_outports);
+    m_escape_requests.resize(m_num_outports);
 
     for (int i = 0; i < m_num_inports; i++) {
         m_round_robin_invc[i] = 0;
+        m_starvation[i].assign(m_num_vcs, 0);
     }
 
     for (int i = 0; i < m_num_outports; i++) {
         m_port_requests[i].resize(m_num_inports);
         m_vc_winners[i].resize(m_num_inports);
+        m_escape_requests[i].resize(m_num_inports);
 
         m_round_robin_inport[i] = 0;
 
         for (int j = 0; j < m_num_inports; j++) {
             m_port_requests[i][j] = false; // [outport][inport]
+            m_escape_requests[i][j] = false;
         }
     }
 }
@@ -107,7 +118,12 @@ SwitchAllocator::wakeup()
  *     has at least one free output VC.
  *    - For BODY/TAIL flits, only selects an input VC that has credits
  *      in its output VC.
+ *    - In escape-VC mode, a HEAD/HEAD_TAIL flit that finds no free
+ *      adaptive VC at its outport requests the escape VC at its
+ *      escape (XY) outport instead.
  * Places a request for the output port from this input VC.
+ * With sa_arbitration other than round robin, the eligible input VC with
+ * the highest priority_key() wins instead.
  */
 
 void
@@ -118,6 +134,13 @@ SwitchAllocator::arbitrate_inports()
     for (int inport = 0; inport < m_num_inports; inport++) {
         int invc = m_round_robin_invc[inport];
 
+        // first and best eligible VC, if not round robin
+        int first_vc = -1;
+        int best_vc = -1;
+        int best_outport = -1;
+        bool best_escape = false;
+        uint64_t best_key = 0;
+
         for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
 
             if (m_input_unit[inport]->need_stage(invc, SA_,
@@ -125,42 +148,152 @@ SwitchAllocator::arbitrate_inports()
 
                 // This flit is in SA stage
 
-                // int  outport = m_input_unit[inport]->get_outport(invc);
-                // get the outport from the flit instead...
-                int outport =
-                        m_input_unit[inport]->peekTopFlit(invc)->get_outport();
-                // int  outvc   = m_input_unit[inport]->get_outvc(invc);
-                int outvc = -1;
+                flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+                int outport = requested_outport(inport, invc);
+                int outvc = m_input_unit[inport]->get_outvc(invc);
                 // check if the flit in this InputVC is allowed to be sent
                 // send_allowed conditions described in that function.
-                bool make_request =
-                    send_allowed(inport, invc, outport, outvc);
-
-                if (make_request) {
-                    m_input_arbiter_activity++;
-                    m_port_requests[outport][inport] = true;
-                    m_vc_winners[outport][inport]= invc;
+                bool bubble_fc_blocked = false;
+                bool make_request = send_allowed(inport, invc, outport,
+                    outvc, false, &bubble_fc_blocked);
+
+                // fall back to the escape VC only when the adaptive
+                // outport is out of VCs, not on a credit, ordering or
+                // reservation stall
+                bool escape = false;
+                if (!make_request && outvc == -1 &&
+                    t_flit->get_escape_outport() != -1 &&
+                    !m_output_unit[outport]->has_free_vc(get_vnet(invc))) {
+                    outport = t_flit->get_escape_outport();
+                    escape = make_request =
+                        send_allowed(inport, invc, outport, outvc, true);
+                }
 
-                    // Update Round Robin pointer
-                    m_round_robin_invc[inport]++;
-                    if (m_round_robin_invc[inport] >= m_num_vcs)
-                        m_round_robin_invc[inport] = 0;
+                // one stall per held-back head flit and cycle
+                if (!make_request && bubble_fc_blocked)
+                    m_router->get_net_ptr()->num_bubble_fc_stalls++;
 
+                if (make_request && m_arbitration == SA_ROUND_ROBIN_) {
+                    place_request(inport, invc, outport, escape);
                     break; // got one vc winner for this port
                 }
+
+                if (make_request) {
+                    // ties go to the VC first in round-robin order
+                    uint64_t key =
+                        priority_key(inport, invc, m_num_vcs - invc_iter);
+                    if (first_vc == -1)
+                        first_vc = invc;
+                    if (best_vc == -1 || key > best_key) {
+                        best_vc = invc;
+                        best_outport = outport;
+                        best_escape = escape;
+                        best_key = key;
+                    }
+                    m_starvation[inport][invc]++;
+                }
             }
 
             invc++;
             if (invc >= m_num_vcs)
                 invc = 0;
         }
+
+        if (best_vc != -1) {
+            if (best_vc != first_vc)
+                m_router->get_net_ptr()->num_sa_priority_overrides++;
+            place_request(inport, best_vc, best_outport, best_escape);
+        }
+    }
+}
+
+void
+SwitchAllocator::place_request(int inport, int invc, int outport,
+                               bool escape)
+{
+    m_input_arbiter_activity++;
+    m_port_requests[outport][inport] = true;
+    m_vc_winners[outport][inport]= invc;
+    m_escape_requests[outport][inport] = escape;
+
+    // Update Round Robin pointer
+    m_round_robin_invc[inport]++;
+    if (m_round_robin_invc[inport] >= m_num_vcs)
+        m_round_robin_invc[inport] = 0;
+}
+
+/*
+ * Priority of the flit at the head of an input VC, packed with its
+ * round-robin rank in the low 16 bits so that a single comparison picks
+ * the winner:
+ *    - SA_OLDEST_FIRST_: cycles since the packet was created at the NI.
+ *    - SA_HOP_COUNT_: hops traversed so far.
+ *    - SA_STARVATION_: 0 until the VC has waited sa_starvation_threshold
+ *      cycles since its last grant; then the number of cycles it waited,
+ *      so the longest starved VC wins.
+ */
+uint64_t
+SwitchAllocator::priority_key(int inport, int invc, int rank)
+{
+    flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+    uint64_t priority = 0;
+
+    switch (m_arbitration) {
+      case SA_OLDEST_FIRST_:
+        priority = m_router->curCycle() - t_flit->get_enqueue_time();
+        break;
+      case SA_HOP_COUNT_:
+        priority = std::max(t_flit->get_route().hops_traversed, 0);
+        break;
+      case SA_STARVATION_:
+        if (m_starvation[inport][invc] >= m_starvation_threshold)
+            priority = m_starvation[inport][invc];
+        break;
+      default:
+        break;
+    }
+
+    const uint64_t max_priority = (1ULL << 48) - 1;
+    return (std::min(priority, max_priority) << 16) | (uint64_t)rank;
+}
+
+// SA-II for sa_arbitration other than round robin: the requesting inport
+// whose VC winner has the highest priority_key().
+int
+SwitchAllocator::highest_priority_inport(int outport)
+{
+    int inport = m_round_robin_inport[outport];
+    int first_inport = -1;
+    int best_inport = inport;
+    uint64_t best_key = 0;
+
+    for (int inport_iter = 0; inport_iter < m_num_inports; inport_iter++) {
+        if (m_port_requests[outport][inport]) {
+            uint64_t key = priority_key(inport,
+                m_vc_winners[outport][inport], m_num_inports - inport_iter);
+            if (first_inport == -1 || key > best_key) {
+                if (first_inport == -1)
+                    first_inport = inport;
+                best_inport = inport;
+                best_key = key;
+            }
+        }
+
+        inport++;
+        if (inport >= m_num_inports)
+            inport = 0;
     }
+
+    if (first_inport != -1 && best_inport != first_inport)
+        m_router->get_net_ptr()->num_sa_priority_overrides++;
+    return best_inport;
 }
 
 /*
  * SA-II (or SA-o) loops through all output ports,
  * and selects one input VC (that placed a request during SA-I)
- * as the winner for this output port in a round robin manner.
+ * as the winner for this output port in a round robin manner
+ * (or by priority_key() with sa_arbitration other than round robin).
  *      - For HEAD/HEAD_TAIL flits, performs simplified outvc allocation.
  *        (i.e., select a free VC from the output port).
  *      - For BODY/TAIL flits, decrement a credit in the output vc.
@@ -179,6 +312,8 @@ SwitchAllocator::arbitrate_outports()
     // Independent arbiter at each output port
     for (int outport = 0; outport < m_num_outports; outport++) {
         int inport = m_round_robin_inport[outport];
+        if (m_arbitration != SA_ROUND_ROBIN_)
+            inport = highest_priority_inport(outport);
 
         for (int inport_iter = 0; inport_iter < m_num_inports;
                  inport_iter++) {
@@ -188,17 +323,83 @@ SwitchAllocator::arbitrate_outports()
 
                 // grant this outport to this inport
                 int invc = m_vc_winners[outport][inport];
+                m_starvation[inport][invc] = 0;
 
                 int outvc = m_input_unit[inport]->get_outvc(invc);
-                assert(outvc == -1);
+                // only a head flit still needs an outvc
+                assert((outvc == -1) ==
+                       is_head(m_input_unit[inport]->peekTopFlit(invc)));
+                bool escape = m_escape_requests[outport][inport];
+
+                // SMART: see if this flit can bypass downstream routers
+                // this cycle. If so, the VC and credit are taken at the
+                // output port of the last bypassed router instead.
+                // Escape-VC packets move one hop at a time.
+                OutputUnit *bypass_unit = NULL;
+                int num_bypassed = 0;
+                if ((m_router->get_net_ptr())->isSmartEnabled() && !escape) {
+                    bypass_unit = m_router->smart_bypass_path(
+                        m_input_unit[inport]->peekTopFlit(invc), outport,
+                        num_bypassed);
+                }
+                OutputUnit *credit_unit = (bypass_unit != NULL) ?
+                    bypass_unit : m_output_unit[outport];
+
                 if (outvc == -1) {
+                    // The rest of the packet follows the head to this
+                    // outport, which may differ from the one computed in
+                    // InputUnit (escape VC, BBR swap).
+                    m_input_unit[inport]->grant_outport(invc, outport);
+
                     // VC Allocation - select any free VC from outport
                     // sets the outVcState to be ACTIVE_
-                    outvc = vc_allocate(outport, inport, invc);
+                    if (bypass_unit != NULL) {
+                        outvc = bypass_unit->select_free_vc(get_vnet(invc));
+                        assert(outvc != -1);
+                        m_input_unit[inport]->grant_outvc(invc, outvc);
+                    } else if (escape) {
+                        outvc = m_output_unit[outport]->
+                            select_free_escape_vc(get_vnet(invc));
+                        assert(outvc != -1);
+                        m_input_unit[inport]->grant_outvc(invc, outvc);
+                    } else {
+                        outvc = vc_allocate(outport, inport, invc);
+                    }
+
+                    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+                    if (net_ptr->isEscapeVcEnabled()) {
+                        net_ptr->increment_vc_class_allocations(
+                            get_vnet(invc), escape);
+                    }
                 }
+                m_output_unit[outport]->mark_granted(m_router->curCycle());
 
                 // remove flit from Input VC <--- Important.
-                flit *t_flit = m_input_unit[inport]->getTopFlit(invc);
+                // A multicast flit at a branch point stays in the VC
+                // until its last branch wins; a copy is sent for every
+                // other branch.
+                flit *t_flit;
+                bool is_fork =
+                    (m_input_unit[inport]->peekTopFlit(invc)->
+                        get_branches().size() > 1);
+                if (is_fork) {
+                    t_flit = m_input_unit[inport]->peekTopFlit(invc)->
+                        fork_branch();
+                    // the next branch allocates its own outvc
+                    m_input_unit[inport]->grant_outvc(invc, -1);
+                    (m_router->get_net_ptr())->num_multicast_forks++;
+                } else {
+                    t_flit = m_input_unit[inport]->getTopFlit(invc);
+                }
+
+                if (bypass_unit != NULL) {
+                    t_flit->set_bypass_unit(bypass_unit);
+                    for (int i = 0; i < num_bypassed; i++)
+                        t_flit->increment_hops();
+                    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+                    net_ptr->num_smart_bypasses++;
+                    net_ptr->num_smart_routers_bypassed += num_bypassed;
+                }
 
                 DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
                                      "granted outvc %d at outport %d "
@@ -231,7 +432,7 @@ SwitchAllocator::arbitrate_outports()
                 cout << "decrementing credit in outvc: router " << m_router->get_id()
                         << " outport: " << outport << " direction: " << m_output_unit[outport]->get_direction() << endl;
                 #endif
-                m_output_unit[outport]->decrement_credit(outvc); // decrement credit here..
+                credit_unit->decrement_credit(outvc); // decrement credit here..
                                                                 // but outVC was alredy ACTIVE_
                                                                 // at this time
                 // flit ready for Switch Traversal
@@ -239,7 +440,10 @@ SwitchAllocator::arbitrate_outports()
                 m_router->grant_switch(inport, t_flit);
                 m_output_arbiter_activity++;
 
-                if ((t_flit->get_type() == TAIL_) ||
+                if (is_fork) {
+                    // the input VC is still in use by the multicast flit;
+                    // no credit is sent back until its last branch leaves
+                } else if ((t_flit->get_type() == TAIL_) ||
                     t_flit->get_type() == HEAD_TAIL_) {
 
                     // This Input VC should now be empty
@@ -299,10 +503,21 @@ SwitchAllocator::arbitrate_outports()
  *     there should be no other flit in this input port
  *     within an ordered vnet
  *     that arrived before this flit and is requesting the same output port.
+ * and
+ * (4) the output port is not reserved this cycle by a flit bypassing
+ *     this router (SMART).
+ * In escape-VC mode, (1) only looks at the adaptive VCs of the output port,
+ * or only at its escape VC if escape is set.
+ * With bubble flow control, a HEAD/HEAD_TAIL flit entering a dimension ring
+ * (see is_ring_entry) needs free buffer slots (credits) for two packets
+ * of its size across the vnet's VCs at the output port, so that the ring
+ * keeps a packet-sized bubble and cannot deadlock. bubble_fc_blocked, if
+ * given, is set when this rule alone held the flit back.
  */
 
 bool
-SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
+SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc,
+                              bool escape, bool *bubble_fc_blocked)
 {
     // Check if outvc needed
     // Check if credit needed (for multi-flit packet)
@@ -310,6 +525,9 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
 
     int vnet = get_vnet(invc);
     bool has_outvc = (outvc != -1);
+
+    if (m_output_unit[outport]->is_reserved(m_router->curCycle()))
+        return false;
     bool has_credit = false;
 
     if (!has_outvc) {
@@ -317,7 +535,11 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
         // needs outvc
         // this is only true for HEAD and HEAD_TAIL flits.
 
-        if (m_output_unit[outport]->has_free_vc(vnet)) {
+        bool has_free_vc = escape ?
+            m_output_unit[outport]->has_free_escape_vc(vnet) :
+            m_output_unit[outport]->has_free_vc(vnet);
+
+        if (has_free_vc) {
 
             has_outvc = true;
 
@@ -333,6 +555,16 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
     if (!has_outvc || !has_credit)
         return false;
 
+    if (outvc == -1 && !escape &&
+        (m_router->get_net_ptr())->isBubbleFlowControl() &&
+        is_ring_entry(inport, outport) &&
+        m_output_unit[outport]->getNumFreeSlots(vnet) <
+            2 * m_input_unit[inport]->peekTopFlit(invc)->get_size()) {
+        if (bubble_fc_blocked)
+            *bubble_fc_blocked = true;
+        return false;
+    }
+
 
     // protocol ordering check
     if ((m_router->get_net_ptr())->isVNetOrdered(vnet)) {
@@ -347,7 +579,7 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
             int temp_vc = vc_base + vc_offset;
             if (m_input_unit[inport]->need_stage(temp_vc, SA_,
                                                  m_router->curCycle()) &&
-               (m_input_unit[inport]->get_outport(temp_vc) == outport) &&
+               (requested_outport(inport, temp_vc) == outport) &&
                (m_input_unit[inport]->get_enqueue_time(temp_vc) <
                     t_enqueue_time)) {
                 return false;
@@ -358,6 +590,26 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
     return true;
 }
 
+// Outport the flit at the head of an input VC requests. A head flit
+// carries its own outport: route compute sets it there, and a BBR swap
+// or spin may change it while the flit waits. Body and tail flits follow
+// the outport granted to their head in SA-II.
+int
+SwitchAllocator::requested_outport(int inport, int invc)
+{
+    flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+    if (is_head(t_flit))
+        return t_flit->get_outport();
+    return m_input_unit[inport]->get_outport(invc);
+}
+
+bool
+SwitchAllocator::is_head(flit *t_flit)
+{
+    return (t_flit->get_type() == HEAD_ ||
+            t_flit->get_type() == HEAD_TAIL_);
+}
+
 // Assign a free VC to the winner of the output port.
 int
 SwitchAllocator::vc_allocate(int outport, int inport, int invc)
@@ -371,6 +623,25 @@ SwitchAllocator::vc_allocate(int outport, int inport, int invc)
     return outvc;
 }
 
+// Bubble flow control: a flit enters a ring when it is injected into
+// (from the Local inport) or turns onto the dimension of the outport.
+// Continuing along the same dimension or ejecting does not.
+bool
+SwitchAllocator::is_ring_entry(int inport, int outport)
+{
+    PortDirection in_dirn = m_input_unit[inport]->get_direction();
+    PortDirection out_dirn = m_output_unit[outport]->get_direction();
+
+    bool out_x = (out_dirn == "East" || out_dirn == "West");
+    bool out_y = (out_dirn == "North" || out_dirn == "South");
+    if (!out_x && !out_y)
+        return false;
+
+    bool in_x = (in_dirn == "East" || in_dirn == "West");
+    bool in_y = (in_dirn == "North" || in_dirn == "South");
+    return !((out_x && in_x) || (out_y && in_y));
+}
+
 // Wakeup the router next cycle to perform SA again
 // if there are flits ready.
 void
@@ -405,6 +676,7 @@ SwitchAllocator::clear_request_vector()
     for (int i = 0; i < m_num_outports; i++) {
         for (int j = 0; j < m_num_inports; j++) {
             m_port_requests[i][j] = false;
+            m_escape_requests[i][j] = false;
         }
     }
 }
@@ -37,11 +37,13 @@
 #include <iostream>
 #include <vector>
 
+#include "base/types.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 
 class Router;
 class InputUnit;
+class flit;
 class OutputUnit;
 
 class SwitchAllocator : public Consumer
@@ -56,8 +58,16 @@ class SwitchAllocator : public Consumer
     void print(std::ostream& out) const {};
     void arbitrate_inports();
     void arbitrate_outports();
-    bool send_allowed(int inport, int invc, int outport, int outvc);
+    bool send_allowed(int inport, int invc, int outport, int outvc,
+                      bool escape = false,
+                      bool *bubble_fc_blocked = NULL);
     int vc_allocate(int outport, int inport, int invc);
+    int requested_outport(int inport, int invc);
+    bool is_head(flit *t_flit);
+    bool is_ring_entry(int inport, int outport);
+    void place_request(int inport, int invc, int outport, bool escape);
+    uint64_t priority_key(int inport, int invc, int rank);
+    int highest_priority_inport(int outport);
 
     inline double
     get_input_arbiter_activity()
@@ -75,6 +85,8 @@ class SwitchAllocator : public Consumer
   private:
     int m_num_inports, m_num_outports;
     int m_num_vcs, m_vc_per_vnet;
+    SaArbitration m_arbitration;
+    uint32_t m_starvation_threshold;
 
     double m_input_arbiter_activity, m_output_arbiter_activity;
 
@@ -83,6 +95,10 @@ class SwitchAllocator : public Consumer
     std::vector<int> m_round_robin_inport;
     std::vector<std::vector<bool>> m_port_requests;
     std::vector<std::vector<int>> m_vc_winners; // a list for each outport
+    // Escape-VC mode: request is for the escape VC of the outport
+    std::vector<std::vector<bool>> m_escape_requests;
+    // SA_STARVATION_: cycles each input VC has waited since its last grant
+    std::vector<std::vector<uint32_t>> m_starvation;
     std::vector<InputUnit *> m_input_unit;
     std::vector<OutputUnit *> m_output_unit;
 };
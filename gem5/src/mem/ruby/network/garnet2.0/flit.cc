@@ -52,6 +52,9 @@ flit::flit(int id, int  vc, int vnet, RouteInfo route, int size,
     m_marked = marked;
     m_outport_dirn = "Unknown";
     m_outport = -1;
+    m_escape_outport = -1;
+    m_bypass_unit = NULL;
+    m_multicast = false;
 
     if (size == 1) {
         m_type = HEAD_TAIL_;
@@ -65,6 +68,27 @@ flit::flit(int id, int  vc, int vnet, RouteInfo route, int size,
         m_type = BODY_;
 }
 
+flit*
+flit::fork_branch()
+{
+    assert(m_branches.size() > 1);
+
+    flit *fork = new flit(*this);
+    fork->m_route.net_dest = m_branches.front().second;
+    fork->m_outport = m_branches.front().first;
+    fork->m_branches.clear();
+    // a marked multicast is counted as injected once per destination,
+    // so every fork stays marked and is counted when it is received
+
+    m_branches.erase(m_branches.begin());
+    m_outport = m_branches.front().first;
+    m_route.net_dest = m_branches.front().second;
+    if (m_branches.size() == 1)
+        m_branches.clear();
+
+    return fork;
+}
+
 // Flit can be printed out for debugging purposes
 void
 flit::print(std::ostream& out) const
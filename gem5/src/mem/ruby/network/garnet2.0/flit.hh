@@ -36,6 +36,8 @@
 
 #include <cassert>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "base/types.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
@@ -43,6 +45,8 @@
 
 typedef std::string PortDirection;
 
+class OutputUnit;
+
 class flit
 {
   public:
@@ -51,6 +55,7 @@ class flit
          MsgPtr msg_ptr, Cycles curTime, bool marked = false);
 
     int get_outport() {return m_outport; }
+    int get_escape_outport() { return m_escape_outport; }
     PortDirection get_outport_dir() { return m_outport_dirn; }
     int get_size() { return m_size; }
     Cycles get_enqueue_time() { return m_enqueue_time; }
@@ -64,14 +69,25 @@ class flit
     flit_type get_type() { return m_type; }
     std::pair<flit_stage, Cycles> get_stage() { return m_stage; }
     Cycles get_src_delay() { return src_delay; }
+    OutputUnit* get_bypass_unit() { return m_bypass_unit; }
+    bool is_multicast() { return m_multicast; }
+    std::vector<std::pair<int, NetDest> >&
+    get_branches() { return m_branches; }
 
     void set_outport(int port) { m_outport = port; }
+    void set_escape_outport(int port) { m_escape_outport = port; }
     void set_outport_dir(PortDirection dirn) { m_outport_dirn = dirn; }
     void set_time(Cycles time) { m_time = time; }
     void set_vc(int vc) { m_vc = vc; }
     void set_route(RouteInfo route) { m_route = route; }
     void set_src_delay(Cycles delay) { src_delay = delay; }
     void set_dequeue_time(Cycles time) { m_dequeue_time = time; }
+    void set_bypass_unit(OutputUnit *unit) { m_bypass_unit = unit; }
+    void set_multicast(bool multicast) { m_multicast = multicast; }
+
+    // Multicast: copy of this flit for the first pending branch.
+    // This flit moves on to the next branch.
+    flit* fork_branch();
 
     void increment_hops() { m_route.hops_traversed++; }
     void print(std::ostream& out) const;
@@ -90,17 +106,6 @@ class flit
         m_stage.second = newTime;
     }
 
-    static bool
-    greater(flit* n1, flit* n2)
-    {
-        if (n1->get_time() == n2->get_time()) {
-            //assert(n1->flit_id != n2->flit_id);
-            return (n1->get_id() > n2->get_id());
-        } else {
-            return (n1->get_time() > n2->get_time());
-        }
-    }
-
     bool functionalWrite(Packet *pkt);
     bool m_marked;
 
@@ -114,10 +119,21 @@ class flit
     flit_type m_type;
     MsgPtr m_msg_ptr;
     int m_outport;
+    // Escape-VC mode: deadlock-free (XY) outport at the current router,
+    // used when no adaptive VC is free at m_outport; -1 if none.
+    int m_escape_outport;
     Cycles src_delay;
     std::pair<flit_stage, Cycles> m_stage;
     // swizzleSwap
     PortDirection m_outport_dirn;
+    // SMART: output unit of the last router this flit bypasses in the
+    // current cycle (NULL when traversing a single hop).
+    OutputUnit *m_bypass_unit;
+    // Multicast: the flit carries a set of destinations in its route.
+    // At a branch point, m_branches holds the outports that still have
+    // to be served and the destinations behind each of them.
+    bool m_multicast;
+    std::vector<std::pair<int, NetDest> > m_branches;
 };
 
 inline std::ostream&
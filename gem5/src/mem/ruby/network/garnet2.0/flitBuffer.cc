@@ -33,51 +33,6 @@
 
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
 
-flitBuffer::flitBuffer()
-{
-    max_size = INFINITE_;
-}
-
-flitBuffer::flitBuffer(int maximum_size)
-{
-    max_size = maximum_size;
-}
-
-bool
-flitBuffer::isEmpty()
-{
-    return (m_buffer.size() == 0);
-}
-
-bool
-flitBuffer::isReady(Cycles curTime)
-{
-    if (m_buffer.size() != 0 ) {
-        flit *t_flit = peekTopFlit();
-        if (t_flit->get_time() <= curTime)
-            return true;
-    }
-    return false;
-}
-
-void
-flitBuffer::print(std::ostream& out) const
-{
-    out << "[flitBuffer: " << m_buffer.size() << "] " << std::endl;
-}
-
-bool
-flitBuffer::isFull()
-{
-    return (m_buffer.size() >= max_size);
-}
-
-void
-flitBuffer::setMaxSize(int maximum)
-{
-    max_size = maximum;
-}
-
 uint32_t
 flitBuffer::functionalWrite(Packet *pkt)
 {
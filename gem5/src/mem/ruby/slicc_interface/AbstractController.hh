@@ -41,7 +41,6 @@
 #ifndef __MEM_RUBY_SLICC_INTERFACE_ABSTRACTCONTROLLER_HH__
 #define __MEM_RUBY_SLICC_INTERFACE_ABSTRACTCONTROLLER_HH__
 
-#include <exception>
 #include <iostream>
 #include <string>
 
@@ -63,13 +62,6 @@
 class Network;
 class GPUCoalescer;
 
-// used to communicate that an in_port peeked the wrong message type
-class RejectException: public std::exception
-{
-    virtual const char* what() const throw()
-    { return "Port rejected message based on type"; }
-};
-
 class AbstractController : public MemObject, public Consumer
 {
   public:
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/slicc_interface/Message.hh"
+
+#include <new>
+
+namespace
+{
+
+// A free message buffer, linked through its own storage
+struct FreeBlock
+{
+    FreeBlock *next;
+};
+
+// Sizes are rounded up to this granularity to pick a free list
+const std::size_t poolGranularity = 16;
+
+// Larger messages bypass the pool
+const std::size_t maxPooledSize = 1024;
+
+// Buffers carved out of the heap at once when a free list runs dry
+const int slabBlocks = 64;
+
+FreeBlock *freeLists[maxPooledSize / poolGranularity + 1];
+
+inline std::size_t
+sizeClass(std::size_t size)
+{
+    return (size + poolGranularity - 1) / poolGranularity;
+}
+
+} // anonymous namespace
+
+void *
+Message::operator new(std::size_t size)
+{
+    if (size > maxPooledSize)
+        return ::operator new(size);
+
+    FreeBlock *&head = freeLists[sizeClass(size)];
+    if (!head) {
+        // Refill the free list with a new slab. Slabs are never
+        // returned to the heap; they are reused by later messages of
+        // the same size class.
+        std::size_t block_size = sizeClass(size) * poolGranularity;
+        char *slab = static_cast<char *>(
+            ::operator new(block_size * slabBlocks));
+        for (int i = slabBlocks - 1; i >= 0; i--) {
+            FreeBlock *block =
+                reinterpret_cast<FreeBlock *>(slab + i * block_size);
+            block->next = head;
+            head = block;
+        }
+    }
+
+    FreeBlock *block = head;
+    head = block->next;
+    return block;
+}
+
+void
+Message::operator delete(void *p, std::size_t size)
+{
+    if (!p)
+        return;
+
+    if (size > maxPooledSize) {
+        ::operator delete(p);
+        return;
+    }
+
+    FreeBlock *block = static_cast<FreeBlock *>(p);
+    FreeBlock *&head = freeLists[sizeClass(size)];
+    block->next = head;
+    head = block;
+}
@@ -29,18 +29,22 @@
 #ifndef __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 #define __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 
+#include <cstddef>
 #include <iostream>
-#include <memory>
 #include <stack>
 
+#include "base/refcnt.hh"
 #include "mem/packet.hh"
 #include "mem/protocol/MessageSizeType.hh"
 #include "mem/ruby/common/NetDest.hh"
 
 class Message;
-typedef std::shared_ptr<Message> MsgPtr;
 
-class Message
+// Ruby runs on a single event queue, so messages are reference counted
+// intrusively and without atomics.
+typedef RefCountingPtr<Message> MsgPtr;
+
+class Message : public RefCounted
 {
   public:
     Message(Tick curTime)
@@ -58,6 +62,15 @@ class Message
 
     virtual ~Message() { }
 
+    /**
+     * Messages are created and destroyed at a high rate, so their
+     * storage is recycled through per-size free lists that are refilled
+     * a slab at a time. Each message type usually has a size class of
+     * its own.
+     */
+    static void *operator new(std::size_t size);
+    static void operator delete(void *p, std::size_t size);
+
     virtual MsgPtr clone() const = 0;
     virtual void print(std::ostream& out) const = 0;
 
@@ -126,6 +139,13 @@ operator>(const MsgPtr &lhs, const MsgPtr &rhs)
     return l->getLastEnqueueTime() > r->getLastEnqueueTime();
 }
 
+inline std::ostream&
+operator<<(std::ostream& out, const MsgPtr& ptr)
+{
+    out << ptr.get();
+    return out;
+}
+
 inline std::ostream&
 operator<<(std::ostream& out, const Message& obj)
 {
@@ -84,6 +84,7 @@ CacheMemory::init()
 
     m_cache.resize(m_cache_num_sets,
                     std::vector<AbstractCacheEntry*>(m_cache_assoc, nullptr));
+    m_tags.assign(m_cache_num_sets * m_cache_assoc, MaxAddr);
 }
 
 CacheMemory::~CacheMemory()
@@ -111,14 +112,11 @@ CacheMemory::addressToCacheSet(Addr address) const
 int
 CacheMemory::findTagInSet(int64_t cacheSet, Addr tag) const
 {
-    assert(tag == makeLineAddress(tag));
-    // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        if (m_cache[cacheSet][it->second]->m_Permission !=
-            AccessPermission_NotPresent)
-            return it->second;
-    return -1; // Not found
+    int loc = findTagInSetIgnorePermissions(cacheSet, tag);
+    if (loc != -1 &&
+        m_cache[cacheSet][loc]->m_Permission == AccessPermission_NotPresent)
+        return -1;
+    return loc;
 }
 
 // Given a cache index: returns the index of the tag in a set.
@@ -128,11 +126,15 @@ CacheMemory::findTagInSetIgnorePermissions(int64_t cacheSet,
                                            Addr tag) const
 {
     assert(tag == makeLineAddress(tag));
-    // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        return it->second;
-    return -1; // Not found
+    // search the set for the tags. The scan has no early exit so the
+    // compiler can compare all ways of the set at once; walking down
+    // keeps the lowest matching way.
+    const Addr *tags = &m_tags[cacheSet * m_cache_assoc];
+    int loc = -1; // Not found
+    for (int i = m_cache_assoc - 1; i >= 0; i--) {
+        loc = (tags[i] == tag) ? i : loc;
+    }
+    return loc;
 }
 
 // Given an unique cache block identifier (idx): return the valid address
@@ -276,7 +278,7 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry, bool touch)
             DPRINTF(RubyCache, "Allocate clearing lock for addr: %x\n",
                     address);
             set[i]->m_locked = -1;
-            m_tag_index[address] = i;
+            m_tags[cacheSet * m_cache_assoc + i] = address;
             entry->setSetIndex(cacheSet);
             entry->setWayIndex(i);
 
@@ -301,7 +303,7 @@ CacheMemory::deallocate(Addr address)
     if (loc != -1) {
         delete m_cache[cacheSet][loc];
         m_cache[cacheSet][loc] = NULL;
-        m_tag_index.erase(address);
+        m_tags[cacheSet * m_cache_assoc + loc] = MaxAddr;
     }
 }
 
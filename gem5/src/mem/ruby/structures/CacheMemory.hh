@@ -31,7 +31,6 @@
 #define __MEM_RUBY_STRUCTURES_CACHEMEMORY_HH__
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "base/statistics.hh"
@@ -170,9 +169,13 @@ class CacheMemory : public SimObject
 
     // The first index is the # of cache lines.
     // The second index is the the amount associativity.
-    std::unordered_map<Addr, int> m_tag_index;
     std::vector<std::vector<AbstractCacheEntry*> > m_cache;
 
+    // Line address held by each way, stored set by set in one
+    // contiguous array (set * assoc + way). Empty ways hold MaxAddr,
+    // which is never a line address.
+    std::vector<Addr> m_tags;
+
     AbstractReplacementPolicy *m_replacementPolicy_ptr;
 
     BankedArray dataArray;
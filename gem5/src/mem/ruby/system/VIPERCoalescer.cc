@@ -213,7 +213,7 @@ VIPERCoalescer::invL1()
     for (int i = 0; i < size; i++) {
         Addr addr = m_dataCache_ptr->getAddressAtIdx(i);
         // Evict Read-only data
-        std::shared_ptr<RubyRequest> msg = std::make_shared<RubyRequest>(
+        RefCountingPtr<RubyRequest> msg = new RubyRequest(
             clockEdge(), addr, (uint8_t*) 0, 0, 0,
             RubyRequestType_REPLACEMENT, RubyAccessMode_Supervisor,
             nullptr);
@@ -240,7 +240,7 @@ VIPERCoalescer::wbL1()
     for (int i = 0; i < size; i++) {
         Addr addr = m_dataCache_ptr->getAddressAtIdx(i);
         // Write dirty data back
-        std::shared_ptr<RubyRequest> msg = std::make_shared<RubyRequest>(
+        RefCountingPtr<RubyRequest> msg = new RubyRequest(
             clockEdge(), addr, (uint8_t*) 0, 0, 0,
             RubyRequestType_FLUSH, RubyAccessMode_Supervisor,
             nullptr);
@@ -264,7 +264,7 @@ VIPERCoalescer::invwbL1()
     for (int i = 0; i < size; i++) {
         Addr addr = m_dataCache_ptr->getAddressAtIdx(i);
         // Evict Read-only data
-        std::shared_ptr<RubyRequest> msg = std::make_shared<RubyRequest>(
+        RefCountingPtr<RubyRequest> msg = new RubyRequest(
             clockEdge(), addr, (uint8_t*) 0, 0, 0,
             RubyRequestType_REPLACEMENT, RubyAccessMode_Supervisor,
             nullptr);
@@ -276,7 +276,7 @@ VIPERCoalescer::invwbL1()
     for (int i = 0; i< size; i++) {
         Addr addr = m_dataCache_ptr->getAddressAtIdx(i);
         // Write dirty data back
-        std::shared_ptr<RubyRequest> msg = std::make_shared<RubyRequest>(
+        RefCountingPtr<RubyRequest> msg = new RubyRequest(
             clockEdge(), addr, (uint8_t*) 0, 0, 0,
             RubyRequestType_FLUSH, RubyAccessMode_Supervisor,
             nullptr);
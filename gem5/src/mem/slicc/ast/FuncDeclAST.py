@@ -67,10 +67,15 @@ class FuncDeclAST(DeclAST):
                 params.append(None)
 
         body = self.slicc.codeFormatter()
+        machine = self.state_machine
         if self.statements is None:
             self["external"] = "yes"
         else:
+            if machine is not None:
+                machine.cur_func = self.ident
             rtype = self.statements.generate(body, return_type)
+            if machine is not None:
+                machine.cur_func = None
 
         self.symtab.popFrame()
 
@@ -85,7 +90,6 @@ class FuncDeclAST(DeclAST):
                     arg_name = arg
                 func_name_args += "_" + str(arg_name)
 
-        machine = self.state_machine
         func = Func(self.symtab, func_name_args, self.ident, self.location,
                     return_type, types, params, str(body), self.pairs)
 
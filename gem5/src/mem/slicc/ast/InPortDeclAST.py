@@ -118,7 +118,9 @@ class InPortDeclAST(DeclAST):
             rcode = self.slicc.codeFormatter()
             rcode.indent()
             rcode.indent()
+            machine.cur_in_port = in_port
             self.statements.generate(rcode, None)
+            machine.cur_in_port = None
             in_port["c_code_in_port"] = str(rcode)
 
         symtab.popFrame()
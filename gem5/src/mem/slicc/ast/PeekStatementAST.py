@@ -65,9 +65,31 @@ class PeekStatementAST(StatementAST):
     in_msg_ptr = dynamic_cast<const $mtid *>(($qcode).${{self.method}}());
     if (in_msg_ptr == NULL) {
         // If the cast fails, this is the wrong inport (wrong message type).
-        // Throw an exception, and the caller will decide to either try a
-        // different inport or punt.
-        throw RejectException();
+''')
+        machine = self.symtab.state_machine
+        in_port = machine.cur_in_port if machine else None
+        if machine is not None and machine.cur_func is not None:
+            # Only the in_port body can hand a message of another type on
+            # to the next in_port; a function called from it cannot.
+            self.error("peek in function '%s': peek in the in_port (or an "
+                       "action) and pass the message fields instead" %
+                       machine.cur_func)
+        if in_port is not None:
+            # Skip the rest of the in_port; the wakeup loop counts the
+            # rejection and moves on to the next in_port
+            machine.rejecting_in_ports.add(in_port)
+            label = machine.inPortRejectLabel(in_port)
+            code('''
+        // Leave this inport so that the next one can try the message.
+        goto $label;
+    }
+''')
+        else:
+            # An action runs after its in_port accepted the message, so a
+            # wrong type here is a protocol bug
+            code('''
+        fatal("Error in %s:%s: executed a peek statement with the wrong "
+              "message type specified.\\n", name(), __func__);
     }
 ''')
 
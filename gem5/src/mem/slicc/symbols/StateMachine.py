@@ -86,6 +86,15 @@ class StateMachine(Symbol):
         self.in_ports = []
         self.functions = []
 
+        # The in_port whose code is currently being generated, and the
+        # in_ports containing a peek that can reject the head message
+        # because it has a different type.
+        self.cur_in_port = None
+        self.rejecting_in_ports = set()
+        # The function whose body is currently being generated; a peek
+        # there could not reject the message (see PeekStatementAST).
+        self.cur_func = None
+
         # Data members in the State Machine that have been declared inside
         # the {} machine.  Note that these along with the config params
         # form the entire set of data members of the machine.
@@ -137,6 +146,11 @@ class StateMachine(Symbol):
     def addInPort(self, var):
         self.in_ports.append(var)
 
+    # Label the wakeup loop jumps to when a peek in an in_port finds a
+    # message of another type, so that the next in_port can claim it
+    def inPortRejectLabel(self, port):
+        return "%s_rejected" % port.ident
+
     def addFunc(self, func):
         # register func in the symbol table
         self.symtab.registerSym(str(func), func)
@@ -947,13 +961,7 @@ void
 $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, ${{self.EntryType.c_ident}}*& m_cache_entry_ptr, Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
-    try {
-       ${{action["c_code"]}}
-    } catch (const RejectException & e) {
-       fatal("Error in action ${{ident}}:${{action.ident}}: "
-             "executed a peek statement with the wrong message "
-             "type specified. ");
-    }
+    ${{action["c_code"]}}
 }
 
 ''')
@@ -1078,6 +1086,13 @@ $c_ident::functionalWriteBuffers(PacketPtr& pkt)
 
         port_to_buf_map, in_msg_bufs, msg_bufs = self.getBufferMaps(ident)
 
+        # rejection counters, one per buffer shared by several in_ports
+        shared_bufs = {}
+        for port in self.in_ports:
+            buf = port_to_buf_map[port]
+            if len(in_msg_bufs[msg_bufs[buf]]) > 1 and buf not in shared_bufs:
+                shared_bufs[buf] = len(shared_bufs)
+
         code('''
 
 using namespace std;
@@ -1087,8 +1102,12 @@ ${ident}_Controller::wakeup()
 {
     int counter = 0;
     while (true) {
-        unsigned char rejected[${{len(msg_bufs)}}];
-        memset(rejected, 0, sizeof(unsigned char)*${{len(msg_bufs)}});
+''')
+        if shared_bufs:
+            code('''
+        unsigned char rejected[${{len(shared_bufs)}}] = {};
+''')
+        code('''
         // Some cases will put us into an infinite loop without this limit
         assert(counter <= m_transitions_per_cycle);
         if (counter == m_transitions_per_cycle) {
@@ -1106,6 +1125,9 @@ ${ident}_Controller::wakeup()
 
         # InPorts
         #
+        # A peek of the wrong message type jumps to the in_port's reject
+        # label. Only buffers shared by several in_ports count the
+        # rejections, to detect a message that no in_port accepts.
         for port in self.in_ports:
             code.indent()
             code('// ${ident}InPort $port')
@@ -1113,18 +1135,24 @@ ${ident}_Controller::wakeup()
                 code('m_cur_in_port = ${{port.pairs["rank"]}};')
             else:
                 code('m_cur_in_port = 0;')
-            if port in port_to_buf_map:
-                code('try {')
-                code.indent()
+            code('{')
             code('${{port["c_code_in_port"]}}')
+            code('}')
 
-            if port in port_to_buf_map:
-                code.dedent()
-                code('''
-            } catch (const RejectException & e) {
-                rejected[${{port_to_buf_map[port]}}]++;
-            }
-''')
+            if port in self.rejecting_in_ports:
+                label = self.inPortRejectLabel(port)
+                buf = port_to_buf_map[port]
+                if buf in shared_bufs:
+                    code('''
+goto ${{port.ident}}_done;
+$label:
+rejected[${{shared_bufs[buf]}}]++;
+${{port.ident}}_done:
+;''')
+                else:
+                    code('''
+$label:
+;''')
             code.dedent()
             code('')
 
@@ -1137,7 +1165,7 @@ ${ident}_Controller::wakeup()
             if len(ports) > 1:
                 # only produce checks when a buffer is shared by multiple ports
                 code('''
-        if (${{buf_name}}->isReady(clockEdge()) && rejected[${{port_to_buf_map[ports[0]]}}] == ${{len(ports)}})
+        if (${{buf_name}}->isReady(clockEdge()) && rejected[${{shared_bufs[port_to_buf_map[ports[0]]]}}] == ${{len(ports)}})
         {
             // no port claimed the message on the top of this buffer
             panic("Runtime Error at Ruby Time: %d. "
@@ -48,6 +48,9 @@ import _m5.event
 from _m5.event import GlobalSimLoopExitEvent as SimExit
 from _m5.event import PyEvent as Event
 from _m5.event import getEventQueue, setEventQueue
+from _m5.event import setEventQueueBinIndex
+from _m5.event import enableHostProfiling
+from _m5.event import enableEventCount
 
 mainq = None
 
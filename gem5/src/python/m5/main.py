@@ -105,6 +105,8 @@ def parse_options():
     group("Statistics Options")
     option("--stats-file", metavar="FILE", default="stats.txt",
         help="Sets the output file for statistics [Default: %default]")
+    option("--stats-jsonl", metavar="FILE", default="",
+        help="Also write statistics as JSON lines to FILE")
 
     # Configuration Options
     group("Configuration Options")
@@ -138,6 +140,18 @@ def parse_options():
     option("--remote-gdb-port", type='int', default=7000,
         help="Remote gdb base port (set to 0 to disable listening)")
 
+    # Event queue options
+    group("Event Queue Options")
+    option("--event-queue", metavar="{linked,indexed}", default="linked",
+        choices=["linked", "indexed"],
+        help="Event queue bin lookup: walk the linked time bins or keep " \
+             "an ordered index of them [Default: %default]")
+    option("--host-profile", metavar="FILE", default="",
+        help="Charge host time to each event and SimObject class and " \
+             "write the ranked table to FILE at exit")
+    option("--event-count", metavar="FILE", default="",
+        help="Write the number of events processed to FILE at exit")
+
     # Help options
     group("Help Options")
     option("--list-sim-objects", action='store_true', default=False,
@@ -343,6 +357,8 @@ def main(*args):
 
     # set stats options
     stats.addStatVisitor(options.stats_file)
+    if options.stats_jsonl:
+        stats.addStatVisitor("jsonl://" + options.stats_jsonl)
 
     # Disable listeners unless running interactively or explicitly
     # enabled
@@ -360,6 +376,13 @@ def main(*args):
     if options.listener_loopback_only:
         m5.listenersLoopbackOnly()
 
+    # select the event queue bin lookup before any events are scheduled
+    event.setEventQueueBinIndex(options.event_queue == "indexed")
+    if options.host_profile:
+        event.enableHostProfiling(options.host_profile)
+    if options.event_count:
+        event.enableEventCount(options.event_count)
+
     # set debugging options
     debug.setRemoteGDBPort(options.remote_gdb_port)
     for when in options.debug_break:
@@ -115,11 +115,27 @@ def _textFactory(fn, desc=True):
 
     return _m5.stats.initText(fn, desc)
 
+@_url_factory
+def _jsonlFactory(fn):
+    """Output stats as JSON lines.
+
+    The first line is a schema record describing every stat; each dump
+    then adds one line holding the values that changed since the
+    previous dump. This keeps periodic dumps small and cheap to parse;
+    util/jsonl_stats.py loads the result.
+
+    Example: jsonl://stats.jsonl
+
+    """
+
+    return _m5.stats.initJsonLines(fn)
+
 factories = {
     # Default to the text factory if we're given a naked path
     "" : _textFactory,
     "file" : _textFactory,
     "text" : _textFactory,
+    "jsonl" : _jsonlFactory,
 }
 
 def addStatVisitor(url):
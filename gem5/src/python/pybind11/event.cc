@@ -48,6 +48,7 @@
 
 #include "base/logging.hh"
 #include "sim/eventq.hh"
+#include "sim/host_profiler.hh"
 #include "sim/sim_events.hh"
 #include "sim/sim_exit.hh"
 #include "sim/simulate.hh"
@@ -114,6 +115,9 @@ pybind_init_event(py::module &m_native)
     m.def("setEventQueue", [](EventQueue *q) { return curEventQueue(q); });
     m.def("getEventQueue", &getEventQueue,
           py::return_value_policy::reference);
+    m.def("setEventQueueBinIndex", &setEventQueueBinIndex);
+    m.def("enableHostProfiling", &enableHostProfiling);
+    m.def("enableEventCount", &enableEventCount);
 
     py::class_<EventQueue>(m, "EventQueue")
         .def("name",  [](EventQueue *eq) { return eq->name(); })
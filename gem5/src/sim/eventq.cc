@@ -34,6 +34,7 @@
 
 #include <cassert>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -44,6 +45,7 @@
 #include "debug/Checkpoint.hh"
 #include "sim/core.hh"
 #include "sim/eventq_impl.hh"
+#include "sim/host_profiler.hh"
 
 using namespace std;
 
@@ -60,6 +62,9 @@ vector<EventQueue *> mainEventQueue;
 __thread EventQueue *_curEventQueue = NULL;
 bool inParallelMode = false;
 
+// Bin index setting applied to newly allocated main event queues
+static bool mainEventQueueBinIndex = false;
+
 EventQueue *
 getEventQueue(uint32_t index)
 {
@@ -67,11 +72,20 @@ getEventQueue(uint32_t index)
         numMainEventQueues++;
         mainEventQueue.push_back(
             new EventQueue(csprintf("MainEventQueue-%d", index)));
+        mainEventQueue.back()->setBinIndex(mainEventQueueBinIndex);
     }
 
     return mainEventQueue[index];
 }
 
+void
+setEventQueueBinIndex(bool enable)
+{
+    mainEventQueueBinIndex = enable;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        mainEventQueue[i]->setBinIndex(enable);
+}
+
 #ifndef NDEBUG
 Counter Event::instanceCounter = 0;
 #endif
@@ -120,6 +134,24 @@ EventQueue::insert(Event *event)
     // Deal with the head case
     if (!head || *event <= *head) {
         head = Event::insertBefore(event, head);
+        if (useBinIndex)
+            binIndex[binKey(head)] = head;
+        return;
+    }
+
+    if (useBinIndex) {
+        // The first bin not ordered before the event is either the
+        // one it belongs on or the one a new bin goes in front of.
+        // The head check above guarantees that a predecessor exists.
+        BinIndex::iterator it = binIndex.lower_bound(binKey(event));
+        Event *curr = it == binIndex.end() ? NULL : it->second;
+        Event *prev = std::prev(it)->second;
+
+        prev->nextBin = Event::insertBefore(event, curr);
+        if (curr && *curr == *event)
+            it->second = event;
+        else
+            binIndex.emplace_hint(it, binKey(event), event);
         return;
     }
 
@@ -180,6 +212,28 @@ EventQueue::remove(Event *event)
     // time as the head)
     if (*head == *event) {
         head = Event::removeItem(event, head);
+        if (useBinIndex) {
+            if (head && *head == *event)
+                binIndex.begin()->second = head;
+            else
+                binIndex.erase(binIndex.begin());
+        }
+        return;
+    }
+
+    if (useBinIndex) {
+        BinIndex::iterator it = binIndex.find(binKey(event));
+        if (it == binIndex.end())
+            panic("event not found!");
+
+        Event *prev = std::prev(it)->second;
+        prev->nextBin = Event::removeItem(event, it->second);
+
+        Event *top = prev->nextBin;
+        if (top && *top == *event)
+            it->second = top;
+        else
+            binIndex.erase(it);
         return;
     }
 
@@ -214,18 +268,30 @@ EventQueue::serviceOne()
 
         // pop the stack
         head = next;
+        if (useBinIndex)
+            binIndex.begin()->second = next;
     } else {
         // this was the only element on the 'in bin' list, so get rid of
         // the 'in bin' list and point to the next bin list
         head = head->nextBin;
+        if (useBinIndex)
+            binIndex.erase(binIndex.begin());
     }
 
     // handle action
     if (!event->squashed()) {
         // forward current cycle to the time when this event occurs.
         setCurTick(event->when());
-
-        event->process();
+        numServiced++;
+
+        if (hostProfiling) {
+            HostProfileSlot slot = hostProfileSlot(event);
+            uint64_t start = hostCycles();
+            event->process();
+            hostProfileCharge(slot, hostCycles() - start);
+        } else {
+            event->process();
+        }
         if (event->isExitEvent()) {
             assert(!event->flags.isSet(Event::Managed) ||
                    !event->flags.isSet(Event::IsMainQueue)); // would be silly
@@ -354,6 +420,22 @@ EventQueue::debugVerify() const
         nextBin = nextBin->nextBin;
     }
 
+    if (useBinIndex) {
+        BinIndex::const_iterator it = binIndex.begin();
+        for (nextBin = head; nextBin; nextBin = nextBin->nextBin, ++it) {
+            if (it == binIndex.end() || it->second != nextBin) {
+                cprintf("bin index out of sync!");
+                nextBin->dump();
+                return false;
+            }
+        }
+
+        if (it != binIndex.end()) {
+            cprintf("bin index has stale bins!");
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -362,9 +444,29 @@ EventQueue::replaceHead(Event* s)
 {
     Event* t = head;
     head = s;
+    if (useBinIndex)
+        rebuildBinIndex();
     return t;
 }
 
+void
+EventQueue::rebuildBinIndex()
+{
+    binIndex.clear();
+    for (Event *bin = head; bin; bin = bin->nextBin)
+        binIndex.emplace_hint(binIndex.end(), binKey(bin), bin);
+}
+
+void
+EventQueue::setBinIndex(bool enable)
+{
+    useBinIndex = enable;
+    if (useBinIndex)
+        rebuildBinIndex();
+    else
+        binIndex.clear();
+}
+
 void
 dumpMainQueue()
 {
@@ -414,7 +516,8 @@ Event::dump() const
 }
 
 EventQueue::EventQueue(const string &n)
-    : objName(n), head(NULL), _curTick(0)
+    : objName(n), head(NULL), _curTick(0), numServiced(0),
+      useBinIndex(false)
 {
 }
 
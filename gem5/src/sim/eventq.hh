@@ -43,9 +43,12 @@
 #include <climits>
 #include <functional>
 #include <iosfwd>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <typeinfo>
+#include <utility>
 
 #include "base/flags.hh"
 #include "base/types.hh"
@@ -82,6 +85,11 @@ extern bool inParallelMode;
 //! is with in bounds.
 EventQueue *getEventQueue(uint32_t index);
 
+//! Select whether the main event queues keep an ordered index of
+//! their time bins. Applies to existing queues and to any queue
+//! allocated later by getEventQueue().
+void setEventQueueBinIndex(bool enable);
+
 inline EventQueue *curEventQueue() { return _curEventQueue; }
 inline void curEventQueue(EventQueue *q) { _curEventQueue = q; }
 
@@ -362,6 +370,15 @@ class Event : public EventBase, public Serializable
     /// describing the event class.
     virtual const char *description() const;
 
+    /// Name and class the host-time profiler charges this event to.
+    /// Wrappers override these to report their callback or owner.
+    virtual std::string profileName() const { return description(); }
+    virtual const std::type_info &
+    profileClass() const
+    {
+        return typeid(*this);
+    }
+
     /// Dump the current event data
     void dump() const;
 
@@ -493,12 +510,39 @@ class EventQueue
     Event *head;
     Tick _curTick;
 
+    //! Number of events processed (not squashed) by serviceOne()
+    uint64_t numServiced;
+
     //! Mutex to protect async queue.
     std::mutex async_queue_mutex;
 
     //! List of events added by other threads to this event queue.
     std::list<Event*> async_queue;
 
+    /**
+     * Optional ordered index over the time bins.
+     *
+     * Each bin in the nextBin list is identified by its (when,
+     * priority) pair and the index maps that key to the top event of
+     * the bin. When enabled, insert() and remove() look up the bin
+     * and its predecessor in the index instead of walking the nextBin
+     * list from the head, which is what dominates when many events
+     * are spread over a handful of future cycles. The linked bins
+     * themselves are maintained exactly as before, so the service
+     * order (including the LIFO order within a bin) is unchanged.
+     */
+    typedef std::pair<Tick, Event::Priority> BinKey;
+    typedef std::map<BinKey, Event *> BinIndex;
+
+    bool useBinIndex;
+    BinIndex binIndex;
+
+    static BinKey binKey(const Event *event)
+    { return BinKey(event->when(), event->priority()); }
+
+    //! Rebuild the bin index from the nextBin list.
+    void rebuildBinIndex();
+
     /**
      * Lock protecting event handling.
      *
@@ -623,6 +667,7 @@ class EventQueue
     void setCurTick(Tick newVal) { _curTick = newVal; }
     Tick getCurTick() const { return _curTick; }
     Event *getHead() const { return head; }
+    uint64_t getNumServiced() const { return numServiced; }
 
     Event *serviceOne();
 
@@ -682,6 +727,10 @@ class EventQueue
      */
     Event* replaceHead(Event* s);
 
+    //! Enable or disable the ordered bin index for this queue.
+    void setBinIndex(bool enable);
+    bool binIndexEnabled() const { return useBinIndex; }
+
     /**@{*/
     /**
      * Provide an interface for locking/unlocking the event queue.
@@ -807,6 +856,8 @@ class EventWrapper : public Event
     }
 
     const char *description() const { return "EventWrapped"; }
+
+    const std::type_info &profileClass() const { return typeid(*object); }
 };
 
 class EventFunctionWrapper : public Event
@@ -835,6 +886,8 @@ class EventFunctionWrapper : public Event
     }
 
     const char *description() const { return "EventFunctionWrapped"; }
+
+    std::string profileName() const { return _name; }
 };
 
 #endif // __SIM_EVENTQ_HH__
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/host_profiler.hh"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/callback.hh"
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "sim/core.hh"
+#include "sim/eventq.hh"
+
+using namespace std;
+
+bool hostProfiling = false;
+
+namespace {
+
+struct ProfileGroup
+{
+    set<type_index> types;
+    Tick clockPeriod;
+};
+
+string profileFile;
+unordered_map<string, HostProfileEntry> byName;
+unordered_map<type_index, HostProfileEntry> byClass;
+map<string, ProfileGroup> groups;
+
+// Taken at enable time to convert host cycles to seconds at exit
+uint64_t startCycles;
+chrono::steady_clock::time_point startTime;
+Tick startTick;
+
+string
+demangle(const char *mangled)
+{
+    int status;
+    char *name = abi::__cxa_demangle(mangled, NULL, NULL, &status);
+    if (status != 0)
+        return mangled;
+
+    string result(name);
+    free(name);
+    return result;
+}
+
+template <class Key>
+vector<pair<Key, HostProfileEntry>>
+ranked(const unordered_map<Key, HostProfileEntry> &table)
+{
+    vector<pair<Key, HostProfileEntry>> rows(table.begin(), table.end());
+    sort(rows.begin(), rows.end(),
+         [](const pair<Key, HostProfileEntry> &a,
+            const pair<Key, HostProfileEntry> &b)
+         { return a.second.cycles > b.second.cycles; });
+    return rows;
+}
+
+void
+printRow(ostream &os, const string &name, const HostProfileEntry &entry,
+         uint64_t total_cycles, double seconds_per_cycle)
+{
+    ccprintf(os, "%-48s %12d %8.2f%% %10.3f %10.1f\n", name, entry.events,
+             total_cycles ? 100.0 * entry.cycles / total_cycles : 0.0,
+             entry.cycles * seconds_per_cycle,
+             entry.events ? double(entry.cycles) / entry.events : 0.0);
+}
+
+void
+writeReport()
+{
+    uint64_t cycles = hostCycles() - startCycles;
+    double seconds = chrono::duration<double>(
+        chrono::steady_clock::now() - startTime).count();
+    double seconds_per_cycle = cycles ? seconds / cycles : 0.0;
+    Tick ticks = curTick() - startTick;
+
+    uint64_t profiled = 0;
+    uint64_t events = 0;
+    for (const auto &entry : byClass) {
+        profiled += entry.second.cycles;
+        events += entry.second.events;
+    }
+
+    OutputStream *out = simout.create(profileFile);
+    ostream &os = *out->stream();
+
+    ccprintf(os, "Host-time event profile\n");
+    ccprintf(os, "events: %d, host seconds: %.3f (%.3f in events), "
+             "simulated ticks: %d\n",
+             events, seconds, profiled * seconds_per_cycle, ticks);
+
+    const char *header = "%-48s %12s %9s %10s %10s\n";
+
+    ccprintf(os, "\nBy class:\n");
+    ccprintf(os, header, "class", "events", "share", "host s",
+             "cyc/event");
+    for (const auto &row : ranked(byClass)) {
+        printRow(os, demangle(row.first.name()), row.second, profiled,
+                 seconds_per_cycle);
+    }
+
+    ccprintf(os, "\nBy event:\n");
+    ccprintf(os, header, "event", "events", "share", "host s",
+             "cyc/event");
+    for (const auto &row : ranked(byName))
+        printRow(os, row.first, row.second, profiled, seconds_per_cycle);
+
+    if (!groups.empty()) {
+        ccprintf(os, "\nGroups:\n");
+        ccprintf(os, "%-16s %9s %10s %14s %18s\n", "group", "share",
+                 "host s", "sim cycles", "sim cycles/host s");
+    }
+    for (const auto &group : groups) {
+        uint64_t group_cycles = 0;
+        for (const auto &entry : byClass) {
+            if (group.second.types.count(entry.first))
+                group_cycles += entry.second.cycles;
+        }
+
+        double group_seconds = group_cycles * seconds_per_cycle;
+        uint64_t sim_cycles = ticks / group.second.clockPeriod;
+        ccprintf(os, "%-16s %8.2f%% %10.3f %14d %18d\n", group.first,
+                 profiled ? 100.0 * group_cycles / profiled : 0.0,
+                 group_seconds, sim_cycles,
+                 uint64_t(group_seconds > 0 ? sim_cycles / group_seconds
+                          : 0));
+    }
+
+    simout.close(out);
+}
+
+struct ReportCallback : public Callback
+{
+    void process() { writeReport(); }
+};
+
+string eventCountFile;
+
+void
+writeEventCount()
+{
+    uint64_t events = 0;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i)
+        events += mainEventQueue[i]->getNumServiced();
+
+    OutputStream *out = simout.create(eventCountFile);
+    ccprintf(*out->stream(), "sim_events %d\n", events);
+    simout.close(out);
+}
+
+struct EventCountCallback : public Callback
+{
+    void process() { writeEventCount(); }
+};
+
+} // anonymous namespace
+
+void
+enableHostProfiling(const string &file)
+{
+    if (hostProfiling)
+        return;
+
+    hostProfiling = true;
+    profileFile = file;
+    startCycles = hostCycles();
+    startTime = chrono::steady_clock::now();
+    startTick = curTick();
+
+    registerExitCallback(new ReportCallback());
+}
+
+void
+enableEventCount(const string &file)
+{
+    if (!eventCountFile.empty())
+        return;
+
+    eventCountFile = file;
+    registerExitCallback(new EventCountCallback());
+}
+
+HostProfileSlot
+hostProfileSlot(const Event *event)
+{
+    auto name = byName.find(event->profileName());
+    if (name == byName.end()) {
+        fatal_if(numMainEventQueues > 1,
+                 "Host profiling needs a single event queue\n");
+        name = byName.emplace(event->profileName(),
+                              HostProfileEntry{0, 0}).first;
+    }
+
+    auto cls = byClass.emplace(type_index(event->profileClass()),
+                               HostProfileEntry{0, 0}).first;
+
+    return HostProfileSlot{&name->second, &cls->second};
+}
+
+void
+hostProfileGroup(const string &group, const type_info &type,
+                 Tick clock_period)
+{
+    ProfileGroup &g = groups[group];
+    g.types.insert(type_index(type));
+    g.clockPeriod = clock_period;
+}
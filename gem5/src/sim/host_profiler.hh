@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2016 Georgia Institute of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SIM_HOST_PROFILER_HH__
+#define __SIM_HOST_PROFILER_HH__
+
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+#include "base/types.hh"
+
+class Event;
+
+/**
+ * Opt-in host-time profiler for the event loop. When enabled,
+ * EventQueue::serviceOne() reads the host cycle counter around every
+ * Event::process() call and charges the cycles to the event's
+ * profileName() and to its profileClass(), the SimObject or Consumer
+ * class the event works for. A ranked table of both is written to a file
+ * in the output directory at exit.
+ *
+ * When disabled the only cost is one test of hostProfiling per event.
+ * The tables are not locked, so profiling requires a single event queue.
+ */
+extern bool hostProfiling;
+
+struct HostProfileEntry
+{
+    uint64_t events;
+    uint64_t cycles;
+};
+
+/** The accumulators one event is charged to. */
+struct HostProfileSlot
+{
+    HostProfileEntry *byName;
+    HostProfileEntry *byClass;
+};
+
+/** Read the host cycle counter (TSC on x86, nanoseconds elsewhere). */
+inline uint64_t
+hostCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Start profiling and write the report to file (relative to the output
+ * directory) when the simulator exits.
+ */
+void enableHostProfiling(const std::string &file);
+
+/**
+ * Write the number of events processed by the main event queues to file
+ * (relative to the output directory) when the simulator exits. This
+ * only reads EventQueue's own counter, so unlike the profiler it adds
+ * no per-event cost, and it keeps the count out of stats.txt.
+ */
+void enableEventCount(const std::string &file);
+
+/** Find the accumulators for an event, creating them if needed. */
+HostProfileSlot hostProfileSlot(const Event *event);
+
+inline void
+hostProfileCharge(const HostProfileSlot &slot, uint64_t cycles)
+{
+    slot.byName->events++;
+    slot.byName->cycles += cycles;
+    slot.byClass->events++;
+    slot.byClass->cycles += cycles;
+}
+
+/**
+ * Add a class to a named group, e.g. all garnet components to "network".
+ * The report gives each group's share of host time and the simulated
+ * cycles (at clock_period) per host second spent in that group alone.
+ */
+void hostProfileGroup(const std::string &group, const std::type_info &type,
+                      Tick clock_period);
+
+#endif // __SIM_HOST_PROFILER_HH__
@@ -31,6 +31,7 @@
 #include <cassert>
 #include <iostream>
 #include <list>
+#include <utility>
 
 #include "base/cprintf.hh"
 #include "base/refcnt.hh"
@@ -148,6 +149,21 @@ main()
     assignmentTarget = NULL;
     EXPECT_EQ(liveChange(), -1);
 
+    // Test that moving a Ptr hands over its reference.
+    setCase("move operators");
+    Ptr moveSource(new TestRC("move source 1"));
+    EXPECT_EQ(liveChange(), 1);
+    Ptr moveTarget(std::move(moveSource));
+    EXPECT_EQ(moveSource.get(), NULL);
+    EXPECT_EQ(liveChange(), 0);
+    moveSource = new TestRC("move source 2");
+    EXPECT_EQ(liveChange(), 1);
+    moveTarget = std::move(moveSource);
+    EXPECT_EQ(moveSource.get(), NULL);
+    EXPECT_EQ(liveChange(), -1);
+    moveTarget = NULL;
+    EXPECT_EQ(liveChange(), -1);
+
     // Test access to members of the pointed to class and dereferencing.
     setCase("access to members");
     TestRC *accessTest = new TestRC("access test");
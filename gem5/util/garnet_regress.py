@@ -0,0 +1,183 @@
+#!/usr/bin/env python2
+
+# Copyright (c) 2016 Georgia Institute of Technology
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Check that Garnet_standalone configurations finish the way they should.
+
+Each case runs configs/example/garnet_synth_traffic.py and matches the
+exit cause gem5 prints ("Exiting @ tick ... because <cause>") against the
+expected one. Runs are capped with --abs-max-tick, so a configuration
+that stops making progress is reported instead of hanging the check.
+Cases that must not finish (e.g. a known deadlock) expect the cap to be
+reached. The script exits with status 1 if any case fails.
+
+Typical use, from the gem5 directory:
+
+    util/garnet_regress.py
+    util/garnet_regress.py --filter multicast --keep
+"""
+
+from __future__ import print_function
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ALL_MARKED = r"All marked packet received"
+TICK_LIMIT = r"simulate\(\) limit reached"
+
+# Name, command-line arguments, expected exit cause (regex)
+CASES = [
+    # sim_type 2 ends once every marked flit is received. Marked
+    # multicasts are counted once per destination on both sides, so the
+    # run must end even when most requests are multicasts.
+    ("multicast-marked",
+     ["--topology=Mesh_XY", "--num-cpus=16", "--num-dirs=16",
+      "--mesh-rows=4", "--routing-algorithm=1", "--vcs-per-vnet=2",
+      "--inj-vnet=0", "--synthetic=uniform_random",
+      "--injectionrate=0.02", "--broadcast-requests", "--multicast",
+      "--sim-type=2"],
+     ALL_MARKED),
+    # BBR swaps rewrite the outport of a waiting head flit; the head must
+    # leave through the new outport. High load so that swaps happen.
+    ("bbr-swap",
+     ["--topology=Mesh_XY", "--num-cpus=16", "--num-dirs=16",
+      "--mesh-rows=4", "--routing-algorithm=2", "--vcs-per-vnet=2",
+      "--inj-vnet=0", "--synthetic=uniform_random",
+      "--injectionrate=0.30", "--swizzle-swap=1", "--policy=1", "--tdm=1",
+      "--sim-type=2"],
+     ALL_MARKED),
+    # Multi-flit packets: body and tail flits follow the outport and VC
+    # granted to their head.
+    ("multi-flit",
+     ["--topology=Mesh_XY", "--num-cpus=16", "--num-dirs=16",
+      "--mesh-rows=4", "--routing-algorithm=1", "--vcs-per-vnet=2",
+      "--inj-vnet=2", "--synthetic=uniform_random",
+      "--injectionrate=0.05", "--sim-type=2"],
+     ALL_MARKED),
+    # ... including a head that falls back to the escape VC at its XY
+    # outport instead of the adaptive one route compute picked.
+    ("multi-flit-escape",
+     ["--topology=Mesh_XY", "--num-cpus=16", "--num-dirs=16",
+      "--mesh-rows=4", "--routing-algorithm=3", "--vcs-per-vnet=2",
+      "--escape-vc", "--inj-vnet=2", "--synthetic=uniform_random",
+      "--injectionrate=0.10", "--sim-type=2"],
+     ALL_MARKED),
+    # Torus rings at saturation with dimension-order (weighted table)
+    # routing: bubble flow control keeps every ring moving, so all marked
+    # packets arrive ...
+    ("torus-bfc",
+     ["--topology=Torus_XY", "--num-cpus=16", "--num-dirs=16",
+      "--mesh-rows=4", "--routing-algorithm=0", "--vcs-per-vnet=2",
+      "--inj-vnet=0", "--synthetic=uniform_random",
+      "--injectionrate=0.60", "--bubble-flow-control", "--sim-type=2"],
+     ALL_MARKED),
+    # ... while the same run without it deadlocks on the wrap-around
+    # cycles and never receives them.
+    ("torus-no-bfc",
+     ["--topology=Torus_XY", "--num-cpus=16", "--num-dirs=16",
+      "--mesh-rows=4", "--routing-algorithm=0", "--vcs-per-vnet=2",
+      "--inj-vnet=0", "--synthetic=uniform_random",
+      "--injectionrate=0.60", "--sim-type=2"],
+     TICK_LIMIT),
+]
+
+COMMON = ["--network=garnet2.0", "--router-latency=1"]
+
+EXIT_CAUSE = re.compile(r"^Exiting @ tick \d+ because (.*)$")
+
+def run_case(gem5, args, max_tick, outdir):
+    """Run one case and return (exit status, exit cause or None)."""
+    cmd = [gem5, "-d", outdir, "configs/example/garnet_synth_traffic.py",
+           "--abs-max-tick=%d" % max_tick] + COMMON + args
+    log_path = os.path.join(outdir, "simout.log")
+    with open(log_path, "w") as log:
+        status = subprocess.call(cmd, stdout=log, stderr=subprocess.STDOUT)
+
+    cause = None
+    with open(log_path) as log:
+        for line in log:
+            match = EXIT_CAUSE.match(line.strip())
+            if match:
+                cause = match.group(1)
+    return status, cause
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Garnet termination and deadlock checks")
+    parser.add_argument("--gem5", default="build/Garnet_standalone/gem5.opt",
+                        help="simulator binary [%(default)s]")
+    parser.add_argument("--max-tick", type=int, default=200000000,
+                        help="tick limit per case [%(default)s]")
+    parser.add_argument("--filter", default="",
+                        help="only run cases whose name matches this regex")
+    parser.add_argument("--keep", action="store_true",
+                        help="keep the per-run output directories")
+    parser.add_argument("--list", action="store_true",
+                        help="print the case names and exit")
+    args = parser.parse_args()
+
+    selected = [c for c in CASES if re.search(args.filter, c[0])]
+    if args.list:
+        for name, _, _ in selected:
+            print(name)
+        return 0
+
+    if not os.path.exists(args.gem5):
+        sys.exit("%s not found; build Garnet_standalone first" % args.gem5)
+    if not os.path.exists("configs/example/garnet_synth_traffic.py"):
+        sys.exit("run this from the gem5 directory")
+
+    workdir = tempfile.mkdtemp(prefix="garnet-regress-")
+    failures = 0
+    for name, case_args, expect in selected:
+        outdir = os.path.join(workdir, name)
+        os.makedirs(outdir)
+        status, cause = run_case(args.gem5, case_args, args.max_tick, outdir)
+        ok = status == 0 and cause is not None and re.search(expect, cause)
+        if not ok:
+            failures += 1
+        print("%-28s %s  (%s)" % (name, "ok" if ok else "FAILED",
+              cause if cause is not None else "exit status %d" % status))
+        sys.stdout.flush()
+
+    if not args.keep:
+        shutil.rmtree(workdir)
+    else:
+        print("run directories kept in %s" % workdir)
+
+    if failures:
+        print("%d case(s) failed" % failures)
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,316 @@
+#!/usr/bin/env python2
+
+# Copyright (c) 2016 Georgia Institute of Technology
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+"""Measure how fast gem5 simulates Garnet_standalone networks.
+
+Runs a fixed matrix of synthetic-traffic configurations (mesh size,
+irregular topologies, routing algorithm, BBR on/off, injection rate)
+one at a time and records, for each run, host seconds, events per host
+second, flits per host second and peak resident memory. The results go
+to a JSON file; given a baseline file from an earlier run on the same
+host, runs that got slower than the threshold are reported and the
+script exits with status 1.
+
+Typical use, from the gem5 directory:
+
+    util/garnet_speed_bench.py --save-baseline bench-base.json
+    ... rebuild with the change under test ...
+    util/garnet_speed_bench.py --baseline bench-base.json
+
+Timings are only comparable on the same host with the same build type,
+so no baseline is checked in.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import platform
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+# Name, extra command-line arguments
+TOPOLOGIES = [
+    ("mesh4x4", ["--topology=Mesh_XY", "--num-cpus=16", "--num-dirs=16",
+                 "--mesh-rows=4"]),
+    ("mesh8x8", ["--topology=Mesh_XY", "--num-cpus=64", "--num-dirs=64",
+                 "--mesh-rows=8"]),
+    ("mesh16x16", ["--topology=Mesh_XY", "--num-cpus=256",
+                   "--num-dirs=256", "--mesh-rows=16"]),
+    ("irregular16", ["--topology=irregularMesh_XY", "--num-cpus=16",
+                     "--num-dirs=16", "--mesh-rows=4", "--conf-file="
+                     "16_nodes-connectivity_matrix_0-links_removed_4.txt"]),
+    ("irregular64", ["--topology=irregularMesh_XY", "--num-cpus=64",
+                     "--num-dirs=64", "--mesh-rows=8", "--conf-file="
+                     "64_nodes-connectivity_matrix_0-links_removed_8.txt"]),
+]
+
+# (mesh name, mesh algorithm, irregular name, irregular algorithm).
+# Irregular topologies have no XY route, so they use the routing table
+# where the meshes use XY. Random adaptive routing does not know about
+# removed links, so it is not run on them (None).
+ROUTING = [
+    ("xy", 1, "table", 0),
+    ("adapt_rand", 3, None, None),
+]
+
+BBR = [
+    ("nobbr", []),
+    ("bbr", ["--swizzle-swap=1", "--policy=1", "--tdm=1"]),
+]
+
+INJECTION = [
+    ("low", 0.02),
+    ("mid", 0.10),
+    ("sat", 0.40),
+]
+
+COMMON = ["--network=garnet2.0", "--router-latency=1", "--inj-vnet=0",
+          "--vcs-per-vnet=2", "--synthetic=uniform_random"]
+
+# Stats read back from stats.txt
+STATS = {
+    "host_seconds": "host_seconds",
+    "flits": "system.ruby.network.flits_received::total",
+}
+
+# Written by gem5 --event-count; kept out of stats.txt so the regression
+# reference stats do not depend on it
+EVENT_COUNT = "event_count.txt"
+
+def cases():
+    for topo, topo_args in TOPOLOGIES:
+        for mesh_route, mesh_algo, irr_route, irr_algo in ROUTING:
+            if topo.startswith("irregular"):
+                route, algo = irr_route, irr_algo
+            else:
+                route, algo = mesh_route, mesh_algo
+            if route is None:
+                continue
+            for bbr, bbr_args in BBR:
+                for inj, rate in INJECTION:
+                    name = "-".join([topo, route, bbr, inj])
+                    args = topo_args + COMMON + bbr_args + [
+                        "--routing-algorithm=%d" % algo,
+                        "--injectionrate=%.2f" % rate,
+                    ]
+                    yield name, args
+
+def read_stats(path):
+    values = {}
+    wanted = dict((v, k) for k, v in STATS.items())
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) >= 2 and fields[0] in wanted:
+                # Keep the first dump only
+                values.setdefault(wanted[fields[0]], float(fields[1]))
+    return values
+
+def read_event_count(path):
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) == 2 and fields[0] == "sim_events":
+                return float(fields[1])
+    return None
+
+def run_case(gem5, name, args, sim_cycles, outdir):
+    cmd = [gem5, "-d", outdir, "--event-count=%s" % EVENT_COUNT,
+           "configs/example/garnet_synth_traffic.py",
+           "--sim-cycles=%d" % sim_cycles] + args
+
+    start = time.time()
+    with open(os.path.join(outdir, "simout.log"), "w") as log:
+        proc = subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT)
+        # wait4 gives this child's own peak RSS, not the max over all
+        # children that getrusage(RUSAGE_CHILDREN) would report
+        _, status, usage = os.wait4(proc.pid, 0)
+        proc.returncode = status
+    wall = time.time() - start
+
+    result = {
+        "name": name,
+        "args": args,
+        "wall_seconds": wall,
+        # ru_maxrss is in KiB on Linux
+        "peak_rss_kb": usage.ru_maxrss,
+    }
+
+    stats_file = os.path.join(outdir, "stats.txt")
+    if status != 0 or not os.path.exists(stats_file):
+        result["status"] = "failed"
+        return result
+
+    result.update(read_stats(stats_file))
+    event_file = os.path.join(outdir, EVENT_COUNT)
+    if os.path.exists(event_file):
+        result["sim_events"] = read_event_count(event_file)
+    result["status"] = "ok"
+    host = result.get("host_seconds")
+    if host:
+        if result.get("sim_events"):
+            result["events_per_second"] = result["sim_events"] / host
+        if "flits" in result:
+            result["flits_per_second"] = result["flits"] / host
+    return result
+
+def best_of(results):
+    """Keep the fastest of repeated runs of one case."""
+    ok = [r for r in results if r["status"] == "ok"]
+    if not ok:
+        return results[0]
+    return min(ok, key=lambda r: r.get("host_seconds", r["wall_seconds"]))
+
+def compare(results, baseline, threshold):
+    """Return the number of cases that are slower or did not complete,
+    in either run; a case without timings cannot be compared."""
+    base = dict((r["name"], r) for r in baseline["results"])
+    regressions = 0
+
+    print("%-36s %10s %10s %8s" % ("case", "base s", "new s", "change"))
+    for r in results:
+        b = base.get(r["name"])
+        if b is None or b["status"] != "ok" or r["status"] != "ok":
+            state = "new" if b is None else \
+                "%s -> %s" % (b["status"], r["status"])
+            flag = ""
+            if r["status"] != "ok" or (b is not None and b["status"] != "ok"):
+                flag = "  FAILED"
+                regressions += 1
+            print("%-36s %s%s" % (r["name"], state, flag))
+            continue
+
+        old = b.get("host_seconds", b["wall_seconds"])
+        new = r.get("host_seconds", r["wall_seconds"])
+        change = new / old - 1.0 if old else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "  SLOWER"
+            regressions += 1
+        print("%-36s %10.2f %10.2f %+7.1f%%%s" %
+              (r["name"], old, new, 100.0 * change, flag))
+
+    return regressions
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Garnet simulation-speed benchmark")
+    parser.add_argument("--gem5", default="build/Garnet_standalone/gem5.opt",
+                        help="simulator binary [%(default)s]")
+    parser.add_argument("--sim-cycles", type=int, default=10000,
+                        help="cycles simulated per case [%(default)s]")
+    parser.add_argument("--filter", default="",
+                        help="only run cases whose name matches this regex")
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="runs per case, the fastest is kept")
+    parser.add_argument("--out", default="garnet-speed-bench.json",
+                        help="results file [%(default)s]")
+    parser.add_argument("--baseline",
+                        help="compare against this results file")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="fractional slowdown reported as a "
+                        "regression [%(default)s]")
+    parser.add_argument("--save-baseline",
+                        help="also write the results to this file")
+    parser.add_argument("--keep", action="store_true",
+                        help="keep the per-run output directories")
+    parser.add_argument("--list", action="store_true",
+                        help="print the case names and exit")
+    args = parser.parse_args()
+
+    selected = [(n, a) for n, a in cases() if re.search(args.filter, n)]
+    if args.list:
+        for name, _ in selected:
+            print(name)
+        return 0
+
+    if not os.path.exists(args.gem5):
+        sys.exit("%s not found; build Garnet_standalone first" % args.gem5)
+    if not os.path.exists("configs/example/garnet_synth_traffic.py"):
+        sys.exit("run this from the gem5 directory")
+
+    workdir = tempfile.mkdtemp(prefix="garnet-bench-")
+    results = []
+    for i, (name, case_args) in enumerate(selected):
+        runs = []
+        for rep in range(args.repeat):
+            outdir = os.path.join(workdir, "%s.%d" % (name, rep))
+            os.makedirs(outdir)
+            runs.append(run_case(args.gem5, name, case_args,
+                                 args.sim_cycles, outdir))
+        result = best_of(runs)
+        results.append(result)
+        print("[%d/%d] %-36s %s %.2fs" %
+              (i + 1, len(selected), name, result["status"],
+               result.get("host_seconds", result["wall_seconds"])))
+        sys.stdout.flush()
+
+    report = {
+        "host": platform.node(),
+        "platform": platform.platform(),
+        "gem5": os.path.abspath(args.gem5),
+        "sim_cycles": args.sim_cycles,
+        "date": time.strftime("%Y-%m-%d %H:%M:%S"),
+        "results": results,
+    }
+
+    for path in filter(None, [args.out, args.save_baseline]):
+        with open(path, "w") as f:
+            json.dump(report, f, indent=1, sort_keys=True)
+
+    if not args.keep:
+        shutil.rmtree(workdir)
+    else:
+        print("run directories kept in %s" % workdir)
+
+    failed = [r["name"] for r in results if r["status"] != "ok"]
+    for name in failed:
+        print("error: %s did not complete" % name)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if baseline.get("sim_cycles") != args.sim_cycles:
+            print("warning: baseline used --sim-cycles=%s" %
+                  baseline.get("sim_cycles"))
+        regressions = compare(results, baseline, args.threshold)
+        if regressions:
+            print("%d case(s) regressed" % regressions)
+            return 1
+
+    return 1 if failed else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,234 @@
+#!/usr/bin/env python2
+
+# Copyright (c) 2016 Georgia Institute of Technology
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Load stats written by the jsonl:// stats backend.
+
+A stats.jsonl file starts with a schema record describing every stat and
+then holds one record per dump with only the values that changed since
+the previous dump. StatsFile replays the records so each dump it yields
+carries the full state at that tick.
+
+    from jsonl_stats import StatsFile
+    for dump in StatsFile("m5out/stats.jsonl").dumps():
+        print(dump.tick, dump.flat()["system.ruby.network.average_hops"])
+
+Run as a script it prints stats in the same "name value" layout as
+stats.txt, optionally filtered by shell-style patterns, or one CSV row
+per dump with --csv.
+"""
+
+from __future__ import print_function
+
+import argparse
+import fnmatch
+import json
+import math
+import sys
+
+def _num(value):
+    return float('nan') if value is None else value
+
+def _dist(base, data, sep):
+    """Expand one distribution the way Text prints it."""
+    samples = _num(data["samples"])
+    total_sum = _num(data["sum"])
+    yield base + sep + "samples", samples
+    yield base + sep + "mean", \
+        total_sum / samples if samples else float('nan')
+    if "logs" in data:
+        yield base + sep + "gmean", \
+            math.exp(_num(data["logs"]) / samples) if samples \
+            else float('nan')
+    stdev = float('nan')
+    if samples > 1:
+        stdev = math.sqrt(max(0.0,
+            (samples * _num(data["squares"]) - total_sum * total_sum) /
+            (samples * (samples - 1.0))))
+    yield base + sep + "stdev", stdev
+
+    if "buckets" not in data:
+        return
+
+    total = sum(_num(c) for c in data["buckets"])
+    if "underflow" in data:
+        total += _num(data["underflow"]) + _num(data["overflow"])
+        yield base + sep + "underflows", _num(data["underflow"])
+
+    bmin = _num(data["min"])
+    size = _num(data["bucket_size"])
+    for i, count in enumerate(data["buckets"]):
+        low = i * size + bmin
+        high = min(low + size - 1.0, _num(data["max"]))
+        name = "%d-%d" % (low, high) if low < high else "%d" % low
+        yield base + sep + name, _num(count)
+
+    if "underflow" in data:
+        yield base + sep + "overflows", _num(data["overflow"])
+        yield base + sep + "min_value", _num(data["min_val"])
+        yield base + sep + "max_value", _num(data["max_val"])
+    yield base + sep + "total", total
+
+def flatten(meta, value, sep="::"):
+    """Yield (name, number) pairs for one stat, named as in stats.txt."""
+    name = meta["name"]
+    kind = meta["kind"]
+    subnames = meta.get("subnames", [])
+
+    def sub(i):
+        return subnames[i] if i < len(subnames) and subnames[i] \
+            else str(i)
+
+    if kind == "scalar":
+        yield name, _num(value)
+    elif kind in ("vector", "formula"):
+        values = value["values"] if kind == "formula" else value
+        for i, v in enumerate(values):
+            # Like Text, elements without a name are hidden once any
+            # element has one.
+            if subnames and (i >= len(subnames) or not subnames[i]):
+                continue
+            yield name + sep + sub(i), _num(v)
+        if kind == "formula":
+            yield name + sep + "total", _num(value["total"])
+        else:
+            yield name + sep + "total", sum(_num(v) for v in values)
+    elif kind == "vector2d":
+        ysub = meta.get("y_subnames", [])
+        y = meta["y"]
+        for i in range(meta["x"]):
+            for j in range(y):
+                col = ysub[j] if j < len(ysub) and ysub[j] else str(j)
+                yield "%s_%s%s%s" % (name, sub(i), sep, col), \
+                    _num(value[i * y + j])
+    elif kind == "dist":
+        for pair in _dist(name, value, sep):
+            yield pair
+    elif kind == "vectordist":
+        for i, data in enumerate(value):
+            for pair in _dist("%s_%s" % (name, sub(i)), data, sep):
+                yield pair
+    elif kind == "sparsehist":
+        yield name + sep + "samples", _num(value["samples"])
+        for key, count in value["buckets"]:
+            yield "%s%s%s" % (name, sep, key), count
+    else:
+        raise ValueError("unknown stat kind '%s'" % kind)
+
+class Dump(object):
+    def __init__(self, stats_file, seq, tick, values):
+        self.stats_file = stats_file
+        self.seq = seq
+        self.tick = tick
+        # Raw values keyed by stat name
+        self.values = values
+
+    def flat(self, patterns=None):
+        """Return {stats.txt name: number}, optionally filtered."""
+        out = {}
+        sep = self.stats_file.separator
+        for name, value in self.values.items():
+            meta = self.stats_file.by_name[name]
+            for flat_name, number in flatten(meta, value, sep):
+                if patterns and not any(fnmatch.fnmatchcase(flat_name, p)
+                                        for p in patterns):
+                    continue
+                out[flat_name] = number
+        return out
+
+class StatsFile(object):
+    def __init__(self, path):
+        self.path = path
+        self.stats = {}
+        self.by_name = {}
+        self.separator = "::"
+
+        with open(path) as f:
+            line = f.readline()
+        if not line:
+            return
+
+        schema = json.loads(line)
+        if schema.get("type") != "schema":
+            raise ValueError("%s: first record is not a schema" % path)
+        self.separator = schema.get("separator", "::")
+        for meta in schema["stats"]:
+            self.stats[meta["id"]] = meta
+            self.by_name[meta["name"]] = meta
+
+    def dumps(self):
+        """Yield every dump in order, each with the full stat state."""
+        state = {}
+        with open(self.path) as f:
+            for line in f:
+                record = json.loads(line)
+                if record.get("type") != "dump":
+                    continue
+                for stat_id, value in record["stats"].items():
+                    state[self.stats[int(stat_id)]["name"]] = value
+                yield Dump(self, record["seq"], record["tick"], dict(state))
+
+    def last(self):
+        dump = None
+        for dump in self.dumps():
+            pass
+        return dump
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Print stats from a gem5 stats.jsonl file")
+    parser.add_argument("file")
+    parser.add_argument("patterns", nargs="*",
+                        help="shell-style stat name patterns")
+    parser.add_argument("--csv", action="store_true",
+                        help="print one row per dump instead of the last "
+                        "dump only")
+    args = parser.parse_args()
+
+    stats = StatsFile(args.file)
+    patterns = args.patterns or None
+
+    if not args.csv:
+        dump = stats.last()
+        if dump is None:
+            return
+        flat = dump.flat(patterns)
+        for name in sorted(flat):
+            print("%-40s %s" % (name, repr(flat[name])))
+        return
+
+    columns = None
+    for dump in stats.dumps():
+        flat = dump.flat(patterns)
+        if columns is None:
+            columns = sorted(flat)
+            print(",".join(["tick"] + columns))
+        print(",".join([str(dump.tick)] +
+                       [repr(flat.get(c, float('nan'))) for c in columns]))
+
+if __name__ == "__main__":
+    main()